@@ -14,7 +14,9 @@
 #include <array>
 #include <thread>
 
+#if defined(_MSC_VER)
 import libksn.multithreading;
+#endif
 
 
 template<class T, class RNG>
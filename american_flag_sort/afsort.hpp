@@ -16,15 +16,20 @@
 
 #include <ksn/ksn.hpp>
 
+#include "../sort_perf/sort_perf.hpp"
+#include "../sort_tuning/sort_tuning.hpp"
+#include "radix_partition.hpp"
+
 _KSN_BEGIN
 namespace detail
 {
-	static constexpr size_t afsort_max_base_log2 = 4;
-	template<class Iter, class ProjFunc, class ExtractFunc, class size_type>
+	static constexpr size_t afsort_max_base_log2 = sort_tuning::afsort_max_base_log2;
+
+	//bucket_log2 sizes the bucket arrays, so that small bases don't pay for clearing 256 counters per call
+	template<size_t bucket_log2, class Iter, class ProjFunc, class ExtractFunc, class size_type>
 	void afsort_backward_recursive_impl(Iter arr, size_type n, ProjFunc&& projection, ExtractFunc&& digit_extractor, uint32_t iterations, uint8_t log2_of_base, uint64_t shift_value)
 	{
-		using bucket_array = std::array<size_type, 1 << afsort_max_base_log2>;
-		using std::iter_swap;
+		using bucket_array = std::array<size_type, 1 << bucket_log2>;
 
 		if (n <= 1)
 			return;
@@ -33,54 +38,25 @@ namespace detail
 		std::span _debug(arr, arr + n);
 #endif
 
-		bucket_array bucket_begins;
+		bucket_array bucket_begins, bucket_ends;
 		const int base = 1 << log2_of_base;
-		constexpr int buckets = (int)std::size(bucket_begins);
+		const int buckets = base;
 
 		auto get_bucket_number = [&]
-		(size_t idx)
+		(const auto& x)
 		{
-			auto result = uint8_t(digit_extractor(projection(arr[idx]), shift_value) & (base - 1));
-			return result;
+			return uint8_t(digit_extractor(projection(x), shift_value) & (base - 1));
 		};
-		bucket_array count{};
-
-		for (size_type i = 0; i < n; ++i)
-			++count[get_bucket_number(i)];
-
-		std::exclusive_scan(count.begin(), count.begin() + buckets, bucket_begins.begin(), (size_type)0);
-
-		bucket_array& bucket_ends = count;
-		for (int i = 0; i < buckets; ++i)
-			bucket_ends[i] = bucket_begins[i] + count[i];
-
-		for (int bucket = buckets - 1; bucket >= 0; --bucket)
-		{
-			if (bucket_ends[bucket] == bucket_begins[bucket])
-				continue;
-
-			size_type& i = --bucket_ends[bucket];
-			do
-			{
-				const int desired_bucket = get_bucket_number(i);
-				if (desired_bucket != bucket)
-					iter_swap(arr + --bucket_ends[desired_bucket], arr + i);
-				else
-				{
-					if (i == bucket_begins[bucket])
-						break;
-					--i;
-				}
-			} while (true);
-		}
+		_radix_partition_in_place(arr, n, get_bucket_number, buckets, bucket_begins.data(), bucket_ends.data());
 
 		if (--iterations == 0 || shift_value == 0)
 			return;
 
+		_KSN_SORT_PERF_SCOPE(sort_perf::phase::recursion);
 		size_type current_end = n;
 		for (int i = buckets - 1; i >= 0; --i)
 		{
-			afsort_backward_recursive_impl(arr + bucket_begins[i], current_end - bucket_begins[i],
+			afsort_backward_recursive_impl<bucket_log2>(arr + bucket_begins[i], current_end - bucket_begins[i],
 				projection, digit_extractor, iterations, log2_of_base, shift_value - log2_of_base);
 			current_end = bucket_begins[i];
 		}
@@ -94,7 +70,10 @@ namespace detail
 		const size_t sz = end - arr;
 		auto invoke_impl = [&]<class size_type>
 		{
-			return afsort_backward_recursive_impl(arr, (size_type)sz, projection, digit_extractor, iterations, log2_of_base, shift);
+			if (log2_of_base <= 4)
+				return afsort_backward_recursive_impl<4>(arr, (size_type)sz, projection, digit_extractor, iterations, log2_of_base, shift);
+			else
+				return afsort_backward_recursive_impl<afsort_max_base_log2>(arr, (size_type)sz, projection, digit_extractor, iterations, log2_of_base, shift);
 		};
 
 		return invoke_impl.template operator() < size_t > ();
@@ -214,8 +193,8 @@ void afsort(
 	if (end - arr <= 1)
 		return;
 
-	if (log2_of_base == (uint8_t)-1) //TODO: proper autopick
-		log2_of_base = detail::afsort_max_base_log2;
+	if (log2_of_base == (uint8_t)-1)
+		log2_of_base = sort_tuning::get(sizeof(T), end - arr).afsort_base_log2;
 	if (log2_of_base > detail::afsort_max_base_log2)
 		throw std::runtime_error("afsort: max base exceeded");
 	//TODO: enforce byte alignment for strings???
@@ -0,0 +1,224 @@
+
+#ifndef _KSN_AFSORT_INDIRECT_HPP_
+#define _KSN_AFSORT_INDIRECT_HPP_
+
+//Indirect American flag sort: sorts 16-byte (cached key prefix, index) entries instead of the elements.
+//Each entry caches the next 8 key bytes, so the permutation passes never touch the elements; they are read
+//again only once every 8 bytes of key depth, and moved once at the end (or never, with afsort_permutation).
+//
+//Keys come from key_fn(element), which returns either an unsigned integer or a contiguous range of bytes
+//(std::string_view and the like), compared as unsigned bytes, shorter first on equal prefixes
+
+#include <vector>
+#include <array>
+#include <string>
+#include <string_view>
+#include <ranges>
+#include <iterator>
+#include <algorithm>
+#include <concepts>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+#include <ksn/ksn.hpp>
+
+#include "radix_partition.hpp"
+
+
+_KSN_BEGIN
+
+namespace detail
+{
+	struct afsort_default_key
+	{
+		template<std::unsigned_integral T>
+		T operator()(const T& x) const
+		{
+			return x;
+		}
+
+		template<class char_t, class traits_t, class alloc_t>
+		std::basic_string_view<char_t, traits_t> operator()(const std::basic_string<char_t, traits_t, alloc_t>& x) const
+		{
+			return x;
+		}
+	};
+
+	struct afsort_indirect_entry
+	{
+		uint64_t prefix; //Next 8 key bytes, big endian, zero padded
+		uint32_t index;
+		uint32_t available; //Valid bytes in prefix
+	};
+
+	//Loads the 8 key bytes at depth into entry
+	template<class Key>
+	void afsort_load_prefix(const Key& key, size_t depth, afsort_indirect_entry& entry)
+	{
+		if constexpr (std::unsigned_integral<Key>)
+		{
+			static_assert(sizeof(Key) <= 8, "afsort_indirect: integer keys up to 64 bits");
+			entry.prefix = depth == 0 ? uint64_t(key) << (64 - sizeof(Key) * CHAR_BIT) : 0;
+			entry.available = depth == 0 ? sizeof(Key) : 0;
+		}
+		else
+		{
+			static_assert(sizeof(*std::ranges::data(key)) == 1, "afsort_indirect: keys must be ranges of bytes");
+			const size_t size = std::ranges::size(key);
+			const auto* bytes = reinterpret_cast<const unsigned char*>(std::ranges::data(key));
+
+			const size_t available = depth < size ? std::min<size_t>(8, size - depth) : 0;
+			uint64_t prefix = 0;
+			for (size_t i = 0; i < available; ++i)
+				prefix |= uint64_t(bytes[depth + i]) << (56 - 8 * i);
+			entry.prefix = prefix;
+			entry.available = (uint32_t)available;
+		}
+	}
+
+	//Orders entries whose keys agree before depth + byte. Falls back to the full keys when all 8 cached bytes tie
+	template<class Iter, class KeyFn>
+	bool afsort_indirect_less(Iter first, KeyFn& key_fn, const afsort_indirect_entry& a, const afsort_indirect_entry& b, size_t depth)
+	{
+		if (a.prefix != b.prefix)
+			return a.prefix < b.prefix;
+		if (a.available != b.available || a.available < 8)
+			return a.available < b.available;
+
+		afsort_indirect_entry x, y;
+		for (depth += 8; ; depth += 8)
+		{
+			afsort_load_prefix(key_fn(first[a.index]), depth, x);
+			afsort_load_prefix(key_fn(first[b.index]), depth, y);
+			if (x.prefix != y.prefix)
+				return x.prefix < y.prefix;
+			if (x.available != y.available || x.available < 8)
+				return x.available < y.available;
+		}
+	}
+
+	//Element i goes to position j where permutation[j] == i. Follows cycles so every element is moved once,
+	//permutation is destroyed
+	template<class Iter, class Index>
+	void afsort_apply_permutation(Iter first, std::vector<Index>& permutation)
+	{
+		using T = typename std::iterator_traits<Iter>::value_type;
+
+		for (size_t i = 0; i < permutation.size(); ++i)
+		{
+			if (permutation[i] == i)
+				continue;
+
+			T carried = std::move(first[i]);
+			size_t j = i;
+			while (true)
+			{
+				const size_t k = permutation[j];
+				permutation[j] = (Index)j;
+				if (k == i)
+				{
+					first[j] = std::move(carried);
+					break;
+				}
+				first[j] = std::move(first[k]);
+				j = k;
+			}
+		}
+	}
+}
+
+//Indices of [first; last) in sorted order, the elements are not moved. Equal keys come in unspecified order
+template<std::random_access_iterator Iter, class KeyFn = detail::afsort_default_key>
+std::vector<uint32_t> afsort_permutation(Iter first, Iter last, KeyFn&& key_fn = {})
+{
+	using entry = detail::afsort_indirect_entry;
+
+	static constexpr size_t small_range = 32;
+	//Bucket 0 holds keys that end before the current byte, bucket 1 + b holds byte b
+	static constexpr size_t buckets = 257;
+
+	const size_t n = last - first;
+	if (n > UINT32_MAX)
+		throw std::runtime_error("afsort_indirect: too many elements");
+
+	std::vector<entry> entries(n);
+	for (size_t i = 0; i < n; ++i)
+	{
+		entries[i].index = (uint32_t)i;
+		detail::afsort_load_prefix(key_fn(first[i]), 0, entries[i]);
+	}
+
+	struct range
+	{
+		size_t begin;
+		size_t end;
+		size_t depth; //Key offset of the cached prefix
+		uint32_t byte; //Byte of the prefix this range is split by
+	};
+	std::vector<range> pending;
+	if (n > 1)
+		pending.push_back({ 0, n, 0, 0 });
+
+	std::array<size_t, buckets> bucket_begins, bucket_ends;
+
+	while (!pending.empty())
+	{
+		const range r = pending.back();
+		pending.pop_back();
+		entry* const arr = entries.data() + r.begin;
+		const size_t size = r.end - r.begin;
+
+		if (size <= small_range)
+		{
+			std::sort(arr, arr + size, [&](const entry& a, const entry& b) { return detail::afsort_indirect_less(first, key_fn, a, b, r.depth); });
+			continue;
+		}
+
+		const uint32_t byte = r.byte;
+		auto digit = [byte](const entry& e) -> size_t
+		{
+			return byte < e.available ? 1 + size_t((e.prefix >> (56 - 8 * byte)) & 0xFF) : 0;
+		};
+		detail::_radix_partition_in_place(arr, size, digit, buckets, bucket_begins.data(), bucket_ends.data());
+
+		for (size_t b = 1; b < buckets; ++b)
+		{
+			const size_t begin = r.begin + bucket_begins[b];
+			const size_t end = b + 1 < buckets ? r.begin + bucket_begins[b + 1] : r.end;
+			if (end - begin <= 1)
+				continue;
+
+			if (byte + 1 < 8)
+				pending.push_back({ begin, end, r.depth, byte + 1 });
+			else
+			{
+				//Cached bytes used up, this is the only time the elements are read again
+				for (size_t i = begin; i < end; ++i)
+					detail::afsort_load_prefix(key_fn(first[entries[i].index]), r.depth + 8, entries[i]);
+				pending.push_back({ begin, end, r.depth + 8, 0 });
+			}
+		}
+	}
+
+	std::vector<uint32_t> permutation(n);
+	for (size_t i = 0; i < n; ++i)
+		permutation[i] = entries[i].index;
+	return permutation;
+}
+
+//Sorts [first; last) through afsort_permutation, moving every element once
+template<std::random_access_iterator Iter, class KeyFn = detail::afsort_default_key>
+void afsort_indirect(Iter first, Iter last, KeyFn&& key_fn = {})
+{
+	auto permutation = afsort_permutation(first, last, key_fn);
+	detail::afsort_apply_permutation(first, permutation);
+}
+
+_KSN_END
+
+#endif //!_KSN_AFSORT_INDIRECT_HPP_
@@ -0,0 +1,241 @@
+
+#ifndef _KSN_RADIX_PARTITION_HPP_
+#define _KSN_RADIX_PARTITION_HPP_
+
+//Partitioning of a range into buckets by a digit function digit(x) -> [0; buckets).
+//Results are bucket offsets: buckets + 1 values, bucket b is [offsets[b]; offsets[b + 1]).
+//
+//radix_partition           in place, cycle-swap permutation as in afsort, not stable
+//radix_partition_copy      out of place and stable, writes go through per-bucket cache-line buffers
+//radix_partition_parallel  out of place and stable, histograms and scatter split between threads
+
+#include <vector>
+#include <array>
+#include <span>
+#include <ranges>
+#include <iterator>
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <ksn/ksn.hpp>
+
+#include "../sort_perf/sort_perf.hpp"
+
+
+_KSN_BEGIN
+
+_KSN_DETAIL_BEGIN
+
+//In-place kernel shared with afsort. bucket_ends is scratch, bucket_begins receives the bucket starts
+template<class Iter, class size_type, class DigitFn>
+void _radix_partition_in_place(Iter arr, size_type n, DigitFn&& digit, size_t buckets, size_type* bucket_begins, size_type* bucket_ends)
+{
+	using std::iter_swap;
+
+	size_type* const count = bucket_ends;
+	std::fill(count, count + buckets, (size_type)0);
+
+	{
+		_KSN_SORT_PERF_SCOPE(sort_perf::phase::histogram, n * sizeof(*arr));
+		for (size_type i = 0; i < n; ++i)
+			++count[digit(arr[i])];
+	}
+
+	{
+		_KSN_SORT_PERF_SCOPE(sort_perf::phase::prefix_sum);
+		std::exclusive_scan(count, count + buckets, bucket_begins, (size_type)0);
+
+		for (size_t i = 0; i < buckets; ++i)
+			bucket_ends[i] = bucket_begins[i] + count[i];
+	}
+
+	_KSN_SORT_PERF_SCOPE(sort_perf::phase::permute, 2 * n * sizeof(*arr));
+	for (ptrdiff_t bucket = buckets - 1; bucket >= 0; --bucket)
+	{
+		if (bucket_ends[bucket] == bucket_begins[bucket])
+			continue;
+
+		size_type& i = --bucket_ends[bucket];
+		do
+		{
+			const size_t desired_bucket = digit(arr[i]);
+			if (desired_bucket != (size_t)bucket)
+				iter_swap(arr + --bucket_ends[desired_bucket], arr + i);
+			else
+			{
+				if (i == bucket_begins[bucket])
+					break;
+				--i;
+			}
+		} while (true);
+	}
+}
+
+template<class In, class DigitFn>
+void _radix_partition_histogram(In first, size_t n, DigitFn& digit, size_t* count)
+{
+	for (size_t i = 0; i < n; ++i)
+		++count[digit(first[i])];
+}
+
+//Stable scatter of [first; first + n) to out at per-bucket positions, advancing them.
+//Trivially copyable elements are staged in a cache line per bucket and written a full line at a time.
+//The first flush of a bucket only goes up to the next line boundary of its destination, so that the
+//following ones cover whole aligned lines instead of straddling two
+template<class In, class Out, class DigitFn>
+void _radix_partition_scatter(In first, size_t n, Out out, DigitFn& digit, size_t buckets, size_t* position)
+{
+	using T = std::iter_value_t<In>;
+
+	if constexpr (std::is_trivially_copyable_v<T> && std::contiguous_iterator<Out> && sizeof(T) <= 64)
+	{
+		static constexpr size_t line_bytes = 64;
+		static constexpr size_t line = line_bytes / sizeof(T);
+
+		const auto staging = std::make_unique_for_overwrite<T[]>(buckets * line);
+		std::vector<uint8_t> fill(buckets), flush_at(buckets, uint8_t(line));
+		T* const dst = std::to_address(out);
+
+		//Lines can only be matched when elements tile them
+		if (line_bytes % sizeof(T) == 0 && uintptr_t(dst) % sizeof(T) == 0)
+		{
+			for (size_t b = 0; b < buckets; ++b)
+			{
+				const size_t misalignment = uintptr_t(dst + position[b]) % line_bytes;
+				if (misalignment != 0)
+					flush_at[b] = uint8_t((line_bytes - misalignment) / sizeof(T));
+			}
+		}
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			const size_t b = digit(first[i]);
+			T* const slot = staging.get() + b * line;
+			slot[fill[b]] = first[i];
+			if (++fill[b] == flush_at[b])
+			{
+				memcpy(dst + position[b], slot, sizeof(T) * fill[b]);
+				position[b] += fill[b];
+				fill[b] = 0;
+				flush_at[b] = uint8_t(line);
+			}
+		}
+
+		for (size_t b = 0; b < buckets; ++b)
+		{
+			if (fill[b] == 0)
+				continue;
+			memcpy(dst + position[b], staging.get() + b * line, sizeof(T) * fill[b]);
+			position[b] += fill[b];
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < n; ++i)
+			out[position[digit(first[i])]++] = first[i];
+	}
+}
+
+_KSN_DETAIL_END
+
+//In-place partition. bucket_offsets.size() is the number of buckets plus one
+template<std::random_access_iterator Iter, class DigitFn>
+void radix_partition(Iter first, Iter last, DigitFn&& digit, std::span<size_t> bucket_offsets)
+{
+	const size_t buckets = bucket_offsets.size() - 1;
+	const size_t n = last - first;
+
+	std::array<size_t, 256> small_scratch;
+	std::vector<size_t> large_scratch(buckets > small_scratch.size() ? buckets : 0);
+	size_t* const scratch = buckets > small_scratch.size() ? large_scratch.data() : small_scratch.data();
+
+	detail::_radix_partition_in_place(first, n, digit, buckets, bucket_offsets.data(), scratch);
+	bucket_offsets[buckets] = n;
+}
+
+template<std::ranges::random_access_range R, class DigitFn>
+std::vector<size_t> radix_partition(R&& range, DigitFn&& digit, size_t buckets)
+{
+	std::vector<size_t> offsets(buckets + 1);
+	radix_partition(std::ranges::begin(range), std::ranges::end(range), digit, std::span(offsets));
+	return offsets;
+}
+
+//Stable out-of-place partition of [first; last) into out
+template<std::random_access_iterator In, std::random_access_iterator Out, class DigitFn>
+std::vector<size_t> radix_partition_copy(In first, In last, Out out, DigitFn&& digit, size_t buckets)
+{
+	const size_t n = last - first;
+	std::vector<size_t> offsets(buckets + 1);
+
+	detail::_radix_partition_histogram(first, n, digit, offsets.data());
+	std::exclusive_scan(offsets.begin(), offsets.end(), offsets.begin(), size_t(0));
+
+	std::vector<size_t> position(offsets.begin(), offsets.end() - 1);
+	detail::_radix_partition_scatter(first, n, out, digit, buckets, position.data());
+	return offsets;
+}
+
+//Stable out-of-place partition on up to threads threads (hardware concurrency by default).
+//digit is called concurrently
+template<std::random_access_iterator In, std::random_access_iterator Out, class DigitFn>
+std::vector<size_t> radix_partition_parallel(In first, In last, Out out, DigitFn&& digit, size_t buckets, size_t threads = 0)
+{
+	static constexpr size_t min_elements_per_thread = 1 << 16;
+
+	const size_t n = last - first;
+	if (threads == 0)
+		threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	threads = std::clamp<size_t>(n / min_elements_per_thread, 1, threads);
+	if (threads == 1)
+		return radix_partition_copy(first, last, out, digit, buckets);
+
+	auto chunk_begin = [&](size_t t) { return n * t / threads; };
+
+	//Thread t's histogram, then its first write position for every bucket
+	std::vector<size_t> counts(threads * buckets);
+
+	auto run = [&](auto&& job)
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(threads - 1);
+		for (size_t t = 1; t < threads; ++t)
+			workers.emplace_back(job, t);
+		job(0);
+		for (auto& worker : workers)
+			worker.join();
+	};
+
+	run([&](size_t t)
+	{
+		detail::_radix_partition_histogram(first + chunk_begin(t), chunk_begin(t + 1) - chunk_begin(t), digit, counts.data() + t * buckets);
+	});
+
+	std::vector<size_t> offsets(buckets + 1);
+	size_t total = 0;
+	for (size_t b = 0; b < buckets; ++b)
+	{
+		offsets[b] = total;
+		for (size_t t = 0; t < threads; ++t)
+			total += std::exchange(counts[t * buckets + b], total);
+	}
+	offsets[buckets] = total;
+
+	run([&](size_t t)
+	{
+		detail::_radix_partition_scatter(first + chunk_begin(t), chunk_begin(t + 1) - chunk_begin(t), out, digit, buckets, counts.data() + t * buckets);
+	});
+
+	return offsets;
+}
+
+_KSN_END
+
+#endif //!_KSN_RADIX_PARTITION_HPP_
@@ -0,0 +1,326 @@
+
+#ifndef _KSN_ASYNC_SORT_HPP_
+#define _KSN_ASYNC_SORT_HPP_
+
+//Sorts as coroutines that suspend every few thousand elements of work, so that a long sort can be
+//interleaved with other work on the same thread, observed and cancelled.
+//
+//	auto task = ksn::async_radix_sort(std::span(v), stop_source.get_token());
+//	while (task.resume())
+//		handle_requests(), report(task.progress());
+//
+//A cancelled sort leaves the range as some permutation of its input
+
+#include <coroutine>
+#include <stop_token>
+#include <exception>
+#include <utility>
+#include <vector>
+#include <array>
+#include <memory>
+#include <span>
+#include <algorithm>
+#include <numeric>
+#include <concepts>
+#include <bit>
+
+#include <stdint.h>
+
+#include <ksn/ksn.hpp>
+
+#include "../american_flag_sort/afsort.hpp"
+#include "../radix_sort/radix_sort.hpp"
+
+
+_KSN_BEGIN
+
+enum class sort_status : uint8_t
+{
+	running,
+	completed,
+	cancelled,
+};
+
+//Lazily started sort coroutine, resumed by its owner
+class sort_task
+{
+public:
+	struct promise_type
+	{
+		double progress = 0;
+		sort_status status = sort_status::running;
+		std::exception_ptr exception;
+
+		sort_task get_return_object()
+		{
+			return sort_task(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+
+		std::suspend_always yield_value(double new_progress) noexcept
+		{
+			progress = new_progress;
+			return {};
+		}
+
+		void return_value(sort_status final_status) noexcept
+		{
+			status = final_status;
+			if (status == sort_status::completed)
+				progress = 1;
+		}
+
+		void unhandled_exception() noexcept
+		{
+			exception = std::current_exception();
+		}
+	};
+
+private:
+	std::coroutine_handle<promise_type> handle;
+
+	explicit sort_task(std::coroutine_handle<promise_type> handle) noexcept
+		: handle(handle)
+	{
+	}
+
+public:
+	sort_task(sort_task&& other) noexcept
+		: handle(std::exchange(other.handle, {}))
+	{
+	}
+
+	sort_task& operator=(sort_task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (handle)
+				handle.destroy();
+			handle = std::exchange(other.handle, {});
+		}
+		return *this;
+	}
+
+	~sort_task()
+	{
+		if (handle)
+			handle.destroy();
+	}
+
+	//Runs the sort until its next suspension point. Returns whether there is work left
+	bool resume()
+	{
+		if (done())
+			return false;
+		handle.resume();
+		if (handle.promise().exception)
+			std::rethrow_exception(std::exchange(handle.promise().exception, {}));
+		return !done();
+	}
+
+	sort_status run()
+	{
+		while (resume());
+		return status();
+	}
+
+	bool done() const noexcept
+	{
+		return !handle || handle.done();
+	}
+
+	//Fraction of the work done, in [0; 1]
+	double progress() const noexcept
+	{
+		return handle ? handle.promise().progress : 1;
+	}
+
+	sort_status status() const noexcept
+	{
+		return handle ? handle.promise().status : sort_status::completed;
+	}
+};
+
+static constexpr size_t async_sort_default_chunk = 1 << 16;
+
+//Counts work and suspends every chunk elements. After resuming, a requested stop runs on_cancel and finishes the sort
+#define _KSN_ASYNC_SORT_CHECKPOINT(work, progress_value, on_cancel) \
+	if ((since_yield += (work)) >= chunk) \
+	{ \
+		since_yield = 0; \
+		co_yield (progress_value); \
+		if (stop.stop_requested()) \
+		{ \
+			on_cancel; \
+			co_return sort_status::cancelled; \
+		} \
+	}
+
+//LSD radix sort with 8-bit digits, stable. Suspends during the histogram sweep and every scatter pass
+template<std::integral T>
+sort_task async_radix_sort(std::span<T> data, std::stop_token stop = {}, size_t chunk = async_sort_default_chunk)
+{
+	using plan = detail::_radix_sort_plan<sizeof(T) * CHAR_BIT, 8>;
+	constexpr size_t key_bits = sizeof(T) * CHAR_BIT;
+
+	const size_t n = data.size();
+	if (n <= 1)
+		co_return sort_status::completed;
+	if (stop.stop_requested())
+		co_return sort_status::cancelled;
+
+	chunk = std::max<size_t>(chunk, 1);
+	size_t since_yield = 0;
+	size_t work_done = 0;
+	const double total_work = double(n) * (plan::passes + 1);
+	auto key = [](T x) { return detail::_radix_sort_key<key_bits>(x); };
+
+	std::vector<size_t> counts(plan::passes * plan::buckets);
+	for (size_t i = 0; i < n; ++i)
+	{
+		const auto k = key(data[i]);
+		for (size_t pass = 0; pass < plan::passes; ++pass)
+			++counts[pass * plan::buckets + ((k >> plan::shift(pass)) & plan::mask(pass))];
+		_KSN_ASYNC_SORT_CHECKPOINT(1, (i + 1) / total_work, (void)0);
+	}
+	work_done = n;
+
+	//Own buffer rather than radix_sort's thread-local one, which interleaved sorts on a thread would share.
+	//Left uninitialized so that its page faults are spread over the first pass instead of stalling one slice
+	const auto aux = std::make_unique_for_overwrite<T[]>(n);
+	T* src = data.data();
+	T* dst = aux.get();
+
+	for (size_t pass = 0; pass < plan::passes; ++pass)
+	{
+		size_t* const count = counts.data() + pass * plan::buckets;
+		const size_t shift = plan::shift(pass);
+		const size_t mask = plan::mask(pass);
+
+		if (count[(key(src[0]) >> shift) & mask] != n)
+		{
+			std::exclusive_scan(count, count + plan::buckets, count, size_t(0));
+
+			//src stays intact until the pass is over, so it is what a cancelled sort leaves behind
+			for (size_t i = 0; i < n; ++i)
+			{
+				dst[count[(key(src[i]) >> shift) & mask]++] = std::move(src[i]);
+				_KSN_ASYNC_SORT_CHECKPOINT(1, (work_done + i + 1) / total_work,
+					if (src != data.data()) std::move(src, src + n, data.data()));
+			}
+			std::swap(src, dst);
+		}
+		work_done += n;
+	}
+
+	if (src != data.data())
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			data[i] = std::move(src[i]);
+			_KSN_ASYNC_SORT_CHECKPOINT(1, 1.0, std::move(src + i + 1, src + n, data.data() + i + 1));
+		}
+	}
+	co_return sort_status::completed;
+}
+
+//MSD American flag sort with 8-bit digits. Buckets of at most chunk elements are finished by afsort in one go,
+//larger ones are partitioned with suspensions in between. Progress is the fraction of elements in finished buckets
+template<std::unsigned_integral T>
+sort_task async_afsort(std::span<T> data, std::stop_token stop = {}, size_t chunk = async_sort_default_chunk)
+{
+	static constexpr size_t digit_bits = 8;
+	static constexpr size_t buckets = size_t(1) << digit_bits;
+
+	const size_t n = data.size();
+	if (n <= 1)
+		co_return sort_status::completed;
+	if (stop.stop_requested())
+		co_return sort_status::cancelled;
+
+	chunk = std::max<size_t>(chunk, 1);
+	size_t since_yield = 0;
+	size_t finished = 0;
+	auto progress = [&] { return double(finished) / n; };
+
+	T max = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		max = std::max(max, data[i]);
+		_KSN_ASYNC_SORT_CHECKPOINT(1, 0.0, (void)0);
+	}
+
+	struct range
+	{
+		size_t begin;
+		size_t size;
+		size_t shift;
+	};
+	std::vector<range> pending;
+	pending.push_back({ 0, n, max == 0 ? 0 : (std::bit_width(max) - 1) / digit_bits * digit_bits });
+
+	std::array<size_t, buckets> bucket_begins, bucket_ends;
+
+	while (!pending.empty())
+	{
+		const range r = pending.back();
+		pending.pop_back();
+		T* const arr = data.data() + r.begin;
+
+		if (r.size <= chunk)
+		{
+			afsort(arr, arr + r.size);
+			finished += r.size;
+			_KSN_ASYNC_SORT_CHECKPOINT(r.size, progress(), (void)0);
+			continue;
+		}
+
+		auto digit = [&](const T& x) { return size_t(x >> r.shift) & (buckets - 1); };
+
+		std::array<size_t, buckets> count{};
+		for (size_t i = 0; i < r.size; ++i)
+		{
+			++count[digit(arr[i])];
+			_KSN_ASYNC_SORT_CHECKPOINT(1, progress(), (void)0);
+		}
+
+		std::exclusive_scan(count.begin(), count.end(), bucket_begins.begin(), size_t(0));
+		for (size_t b = 0; b < buckets; ++b)
+			bucket_ends[b] = bucket_begins[b] + count[b];
+
+		//Cycle leader permutation, every swap puts one element into its bucket for good.
+		//bucket_begins/bucket_ends live in the coroutine frame, so suspending in the middle is fine
+		std::array<size_t, buckets> next = bucket_begins;
+		for (size_t b = 0; b < buckets; ++b)
+		{
+			while (next[b] < bucket_ends[b])
+			{
+				const size_t d = digit(arr[next[b]]);
+				if (d == b)
+					++next[b];
+				else
+					std::iter_swap(arr + next[b], arr + next[d]++);
+				_KSN_ASYNC_SORT_CHECKPOINT(1, progress(), (void)0);
+			}
+		}
+
+		for (size_t b = 0; b < buckets; ++b)
+		{
+			const size_t size = bucket_ends[b] - bucket_begins[b];
+			if (size <= 1 || r.shift == 0)
+				finished += size;
+			else
+				pending.push_back({ r.begin + bucket_begins[b], size, r.shift - digit_bits });
+		}
+	}
+
+	co_return sort_status::completed;
+}
+
+#undef _KSN_ASYNC_SORT_CHECKPOINT
+
+_KSN_END
+
+#endif //!_KSN_ASYNC_SORT_HPP_
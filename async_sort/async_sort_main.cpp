@@ -0,0 +1,76 @@
+
+#include "async_sort.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+
+//Resumes the sort between simulated requests and reports the longest stall the requests saw
+template<class T>
+void interleave(const char* name, ksn::sort_task task, const std::vector<T>& v)
+{
+	using clock = std::chrono::steady_clock;
+
+	size_t resumes = 0;
+	double worst_us = 0;
+	double next_report = 0.25;
+
+	const auto start = clock::now();
+	while (true)
+	{
+		const auto t1 = clock::now();
+		const bool more = task.resume();
+		const auto t2 = clock::now();
+
+		++resumes;
+		worst_us = std::max(worst_us, std::chrono::duration<double, std::micro>(t2 - t1).count());
+		if (task.progress() >= next_report)
+		{
+			std::cout << "  " << name << ": " << std::setw(3) << int(task.progress() * 100) << "%\n";
+			next_report += 0.25;
+		}
+		if (!more)
+			break;
+	}
+	const auto total_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+	std::cout << name << ": " << total_ms << " ms in " << resumes << " slices, longest slice " << worst_us << " us, " <<
+		(std::ranges::is_sorted(v) ? "sorted" : "NOT SORTED") << "\n";
+}
+
+int main()
+{
+	constexpr size_t N = 20'000'000;
+
+	std::mt19937_64 rng;
+	std::vector<uint32_t> v0(N);
+	for (auto& x : v0)
+		x = (uint32_t)rng();
+
+	auto v = v0;
+	interleave("async_radix_sort", ksn::async_radix_sort(std::span(v)), v);
+
+	v = v0;
+	interleave("async_afsort", ksn::async_afsort(std::span(v)), v);
+
+	//Cancel half way through
+	v = v0;
+	std::stop_source stop;
+	auto task = ksn::async_radix_sort(std::span(v), stop.get_token());
+	while (task.resume())
+		if (task.progress() >= 0.5)
+			stop.request_stop();
+
+	std::ranges::sort(v);
+	auto sorted = v0;
+	std::ranges::sort(sorted);
+	std::cout << "cancelled at " << int(task.progress() * 100) << "%: " <<
+		(task.status() == ksn::sort_status::cancelled ? "cancelled" : "not cancelled") << ", " <<
+		(v == sorted ? "input preserved" : "INPUT LOST") << "\n";
+
+	return 0;
+}
@@ -0,0 +1,94 @@
+
+#include "run_files.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <algorithm>
+
+
+//Checks every run file is sorted and the runs hold exactly the input records (by count and checksum)
+bool check_runs(const std::vector<std::filesystem::path>& runs, size_t n, uint64_t sum, uint64_t xor_sum)
+{
+	size_t total = 0;
+	for (const auto& path : runs)
+	{
+		ksn::record_reader<uint64_t> reader(path, 1 << 16);
+		uint64_t x, previous = 0;
+		size_t count = 0;
+		while (reader.read(x))
+		{
+			if (count++ != 0 && x < previous)
+				return false;
+			previous = x;
+			sum -= x;
+			xor_sum ^= x;
+		}
+		if (count == 0)
+			return false;
+		total += count;
+	}
+	return total == n && sum == 0 && xor_sum == 0;
+}
+
+int main(int argc, char** argv)
+{
+	const size_t n = argc > 1 ? std::stoull(argv[1]) : 50'000'000;
+	const size_t budget = argc > 2 ? std::stoull(argv[2]) : size_t(64) << 20;
+
+	std::mt19937_64 rng(std::random_device{}());
+	const auto directory = std::filesystem::temp_directory_path() / ("aads_external_sort_" + std::to_string(rng() % 1'000'000'000));
+	std::filesystem::create_directories(directory);
+	const auto input = directory / "input.bin";
+
+	for (const char* distribution : { "random", "ascending", "descending" })
+	{
+		uint64_t sum = 0, xor_sum = 0;
+		{
+			ksn::record_writer<uint64_t> writer(input, 1 << 16);
+			for (size_t i = 0; i < n; ++i)
+			{
+				uint64_t x = rng();
+				if (distribution[0] == 'a')
+					x = i;
+				else if (distribution[0] == 'd')
+					x = n - i;
+				sum += x;
+				xor_sum ^= x;
+				writer.write(x);
+			}
+		}
+
+		ksn::run_files_options options;
+		options.memory_budget = budget;
+		options.io_buffer = std::min<size_t>(options.io_buffer, budget / 64);
+
+		const auto t1 = std::chrono::steady_clock::now();
+		const auto runs = ksn::write_sorted_runs<uint64_t>(input, directory / distribution, options);
+		const auto t2 = std::chrono::steady_clock::now();
+
+		//Load-sort-store with the same budget would write runs of at most one budget worth of records
+		const double budget_records = double(budget / sizeof(uint64_t));
+		const double average = runs.empty() ? 0 : double(n) / runs.size();
+		//Not counting the last run, which only gets what is left of the input
+		const double full_average = runs.size() < 2 ? average :
+			double(n - std::filesystem::file_size(runs.back()) / sizeof(uint64_t)) / (runs.size() - 1);
+
+		std::cout << std::setw(10) << distribution << ": " << runs.size() << " runs, average length " << std::fixed << std::setprecision(2) <<
+			full_average / budget_records << "x memory budget, " << std::chrono::duration<double>(t2 - t1).count() << " s\n";
+		if (!check_runs(runs, n, sum, xor_sum))
+			std::cout << "Error: runs of " << distribution << " input are not the sorted input\n";
+		//Random input should give runs of about twice the heap, which is nearly all of the budget
+		if (distribution[0] == 'r' && runs.size() >= 3 && full_average < 1.8 * budget_records)
+			std::cout << "Error: runs of random input average " << full_average / budget_records << "x the memory budget, expected about 2x\n";
+
+		std::filesystem::remove_all(directory / distribution);
+	}
+
+	std::filesystem::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,132 @@
+
+#ifndef _KSN_REPLACEMENT_SELECTION_HPP_
+#define _KSN_REPLACEMENT_SELECTION_HPP_
+
+//Sorted run generation by replacement selection.
+//A min-heap of capacity elements holds the input: once it is full, every new element replaces the smallest one,
+//which is written out. An element smaller than the one it replaced can't join the current run any more, so the
+//heap shrinks by one and the element is parked behind it, in the same array. When the heap runs empty the array
+//is all parked elements, which are heapified to start the next run. No per-element run tag: on random input
+//runs average twice the capacity, presorted input comes out as a single run
+
+#include <vector>
+#include <memory_resource>
+#include <iterator>
+#include <functional>
+#include <utility>
+
+#include <ksn/ksn.hpp>
+
+#include "../heap/heap.hpp"
+
+
+_KSN_BEGIN
+
+template<class T, class Comp = std::less<T>>
+class replacement_selection
+{
+	//[0; m_heap_size) is the heap of the current run, [m_heap_size; size()) the elements parked for the next one
+	std::pmr::vector<T> m_data;
+	[[no_unique_address]] Comp m_comp;
+	size_t m_capacity;
+	size_t m_heap_size = 0;
+	size_t m_run = 0;
+
+	void start_next_run()
+	{
+		++m_run;
+		::make_heap(m_data, m_comp);
+		m_heap_size = m_data.size();
+	}
+
+public:
+	explicit replacement_selection(size_t capacity, Comp comp = {}, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: m_data(resource), m_comp(std::move(comp)), m_capacity(capacity ? capacity : 1)
+	{
+		m_data.reserve(m_capacity);
+	}
+
+	size_t capacity() const noexcept
+	{
+		return m_capacity;
+	}
+	size_t size() const noexcept
+	{
+		return m_data.size();
+	}
+
+	//Adds x. Once the heap is full, the smallest element of the current run leaves it through emit(run, T&&)
+	template<class Emit>
+	void push(T x, Emit&& emit)
+	{
+		//Nothing is parked before the array fills up
+		if (m_data.size() < m_capacity)
+		{
+			::push_heap(m_data, std::move(x), m_comp);
+			m_heap_size = m_data.size();
+			return;
+		}
+
+		const bool next_run = m_comp(x, m_data.front());
+		emit(m_run, std::move(m_data.front()));
+		if (!next_run)
+		{
+			//Replacing the top takes one sift down instead of an erase_min_heap and a push_heap
+			m_data.front() = std::move(x);
+			::sift_down(m_data, 0, m_heap_size, m_comp);
+			return;
+		}
+
+		if (--m_heap_size == 0)
+		{
+			m_data.front() = std::move(x);
+			return start_next_run();
+		}
+		m_data.front() = std::move(m_data[m_heap_size]);
+		m_data[m_heap_size] = std::move(x);
+		::sift_down(m_data, 0, m_heap_size, m_comp);
+	}
+
+	//Writes out everything left in the heap. Returns the number of runs produced so far;
+	//elements pushed afterwards start a new run
+	template<class Emit>
+	size_t finish(Emit&& emit)
+	{
+		if (m_data.empty())
+			return m_run;
+
+		//Drains the current run, then the parked elements as the next one
+		while (true)
+		{
+			for (size_t n = m_heap_size; n-- > 0; )
+			{
+				emit(m_run, std::move(m_data.front()));
+				if (n == 0)
+					break;
+				m_data.front() = std::move(m_data[n]);
+				::sift_down(m_data, 0, n, m_comp);
+			}
+			m_data.erase(m_data.begin(), m_data.begin() + m_heap_size);
+			if (m_data.empty())
+				break;
+			start_next_run();
+		}
+		m_heap_size = 0;
+		return ++m_run;
+	}
+};
+
+//Runs [first; last) through replacement selection with a heap of capacity elements,
+//calling emit(run, T&&) in output order. Returns the number of runs
+template<std::input_iterator Iter, std::sentinel_for<Iter> Sentinel, class Emit, class Comp = std::less<std::iter_value_t<Iter>>>
+size_t generate_runs(Iter first, Sentinel last, size_t capacity, Emit&& emit, Comp comp = {})
+{
+	replacement_selection<std::iter_value_t<Iter>, Comp> selection(capacity, std::move(comp));
+	for (; first != last; ++first)
+		selection.push(*first, emit);
+	return selection.finish(emit);
+}
+
+_KSN_END
+
+#endif //!_KSN_REPLACEMENT_SELECTION_HPP_
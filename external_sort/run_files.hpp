@@ -0,0 +1,147 @@
+
+#ifndef _KSN_RUN_FILES_HPP_
+#define _KSN_RUN_FILES_HPP_
+
+//Streaming file front end of replacement selection: binary files of trivially copyable records
+//are read and written through fixed-size buffers, so the heap gets almost all of the memory budget
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+#include <functional>
+#include <algorithm>
+
+#include <ksn/ksn.hpp>
+
+#include "replacement_selection.hpp"
+
+
+_KSN_BEGIN
+
+template<class T>
+class record_reader
+{
+	static_assert(std::is_trivially_copyable_v<T>, "record_reader: records must be trivially copyable");
+
+	std::ifstream m_file;
+	std::unique_ptr<T[]> m_buffer;
+	size_t m_capacity, m_size = 0, m_pos = 0;
+
+public:
+	record_reader(const std::filesystem::path& path, size_t buffer_records)
+		: m_file(path, std::ios::binary), m_buffer(std::make_unique_for_overwrite<T[]>(buffer_records ? buffer_records : 1)),
+		m_capacity(buffer_records ? buffer_records : 1)
+	{
+		if (!m_file)
+			throw std::runtime_error("record_reader: can't open " + path.string());
+	}
+
+	//false at the end of the file. A trailing partial record is ignored
+	bool read(T& x)
+	{
+		if (m_pos == m_size)
+		{
+			m_file.read(reinterpret_cast<char*>(m_buffer.get()), std::streamsize(m_capacity * sizeof(T)));
+			m_size = size_t(m_file.gcount()) / sizeof(T);
+			m_pos = 0;
+			if (m_size == 0)
+			{
+				if (m_file.bad())
+					throw std::runtime_error("record_reader: read error");
+				return false;
+			}
+		}
+		x = m_buffer[m_pos++];
+		return true;
+	}
+};
+
+template<class T>
+class record_writer
+{
+	static_assert(std::is_trivially_copyable_v<T>, "record_writer: records must be trivially copyable");
+
+	std::ofstream m_file;
+	std::unique_ptr<T[]> m_buffer;
+	size_t m_capacity, m_size = 0;
+
+public:
+	record_writer(const std::filesystem::path& path, size_t buffer_records)
+		: m_file(path, std::ios::binary | std::ios::trunc), m_buffer(std::make_unique_for_overwrite<T[]>(buffer_records ? buffer_records : 1)),
+		m_capacity(buffer_records ? buffer_records : 1)
+	{
+		if (!m_file)
+			throw std::runtime_error("record_writer: can't create " + path.string());
+	}
+	~record_writer()
+	{
+		if (m_size != 0)
+			m_file.write(reinterpret_cast<const char*>(m_buffer.get()), std::streamsize(m_size * sizeof(T)));
+	}
+
+	void write(const T& x)
+	{
+		m_buffer[m_size++] = x;
+		if (m_size == m_capacity)
+			flush();
+	}
+
+	void flush()
+	{
+		m_file.write(reinterpret_cast<const char*>(m_buffer.get()), std::streamsize(m_size * sizeof(T)));
+		m_size = 0;
+		if (!m_file)
+			throw std::runtime_error("record_writer: write error");
+	}
+};
+
+struct run_files_options
+{
+	size_t memory_budget = size_t(256) << 20; //Bytes for the heap and both I/O buffers
+	size_t io_buffer = size_t(1) << 20; //Bytes per I/O buffer
+};
+
+//Splits the records of input into sorted runs written to directory/run_<i>.bin, returns their paths in order
+template<class T, class Comp = std::less<T>>
+std::vector<std::filesystem::path> write_sorted_runs(const std::filesystem::path& input, const std::filesystem::path& directory,
+	const run_files_options& options = {}, Comp comp = {})
+{
+	const size_t buffer_records = std::max<size_t>(1, options.io_buffer / sizeof(T));
+	const size_t buffers_size = 2 * buffer_records * sizeof(T);
+	const size_t heap_capacity = options.memory_budget > buffers_size ? (options.memory_budget - buffers_size) / sizeof(T) : 1;
+
+	std::filesystem::create_directories(directory);
+
+	std::vector<std::filesystem::path> runs;
+	std::unique_ptr<record_writer<T>> writer;
+	auto emit = [&](size_t run, T&& x)
+	{
+		if (run == runs.size())
+		{
+			runs.push_back(directory / ("run_" + std::to_string(run) + ".bin"));
+			if (writer)
+				writer->flush();
+			writer = std::make_unique<record_writer<T>>(runs.back(), buffer_records);
+		}
+		writer->write(x);
+	};
+
+	record_reader<T> reader(input, buffer_records);
+	replacement_selection<T, Comp> selection(heap_capacity, std::move(comp));
+	T x;
+	while (reader.read(x))
+		selection.push(x, emit);
+	selection.finish(emit);
+
+	if (writer)
+		writer->flush();
+	return runs;
+}
+
+_KSN_END
+
+#endif //!_KSN_RUN_FILES_HPP_
@@ -1,4 +1,5 @@
 
+#if defined(_MSC_VER)
 import <vector>;
 import <concepts>;
 import <utility>;
@@ -6,89 +7,198 @@ import <iterator>;
 import <algorithm>;
 import <functional>;
 import <random>;
+import <chrono>;
+import <iostream>;
+import <memory_resource>;
+import <string>;
+import <stdexcept>;
+import <bit>;
 
 import <ksn/metapr.hpp>;
+#else
+#include <vector>
+#include <concepts>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <stdexcept>
+#include <bit>
 
-template<class T, ksn::universal_reference<T> Tref, class Comp = std::less<T>>
-void push_heap(std::pmr::vector<T>& arr, Tref&& x, Comp&& comp = {})
+#include <ksn/metapr.hpp>
+#endif
+
+#include "heap.hpp"
+#include "heap_queue.hpp"
+#include "parallel_heap.hpp"
+
+
+template<class Callable>
+double measure_ms(Callable&& f)
 {
-	size_t n = arr.size();
-	arr.push_back(std::forward<T>(x));
-	while (n)
-	{
-		size_t parent = (n - 1) / 2;
-		if (!comp(arr[parent], arr[n]))
-			std::swap(arr[parent], arr[n]);
-		n = parent;
-	}
+	const auto t1 = std::chrono::steady_clock::now();
+	f();
+	const auto t2 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(t2 - t1).count();
 }
 
-template<class T, class Comp = std::less<T>>
-void sift_down(std::pmr::vector<T>& arr, size_t n, size_t N, Comp&& comp = {})
+//Construction and melding of large heaps
+void bulk_benchmark(size_t n)
 {
-	while (n < N)
+	std::mt19937_64 engine;
+	std::pmr::vector<int> v0, v;
+	std::generate_n(std::back_inserter(v0), n, [&] {return (int)engine(); });
+	std::pmr::vector<int> extra(v0.begin(), v0.begin() + n / 100);
+
+	auto is_min_heap = [](const std::pmr::vector<int>& h) { return std::is_heap(h.begin(), h.end(), std::greater<>{}); };
+
+	v = v0;
+	const double sequential = measure_ms([&] { make_heap(v); });
+	v = v0;
+	const double parallel = measure_ms([&] { parallel_make_heap(v); });
+	if (!is_min_heap(v))
+		std::cout << "Error: parallel_make_heap\n";
+	std::cout << "make_heap of " << n << ": " << sequential << " ms, parallel_make_heap " << parallel << " ms\n";
+
+	//Explicit thread counts, so the subtree split runs even on a single core machine
+	for (size_t threads : { 2, 3, 4, 16 })
 	{
-		size_t min = n;
-		for (size_t i = 2 * n + 1; i <= 2 * n + 2; ++i)
-		{
-			if (i < N && !comp(arr[min], arr[i]))
-				min = i;
-		}
-		if (min == n)
-			break;
-		std::swap(arr[n], arr[min]);
-		n = min;
+		auto forced = v0;
+		parallel_make_heap(forced, std::less<>{}, threads);
+		if (!is_min_heap(forced))
+			std::cout << "Error: parallel_make_heap with " << threads << " threads\n";
 	}
-}
 
-template<class T, class Comp = std::less<T>>
-T erase_min_heap(std::pmr::vector<T>& arr, Comp&& comp = {})
-{
-	T min_value = std::move(arr.front());
-	arr.front() = std::move(arr.back());
-	arr.pop_back();
-	sift_down(arr, 0, arr.size(), comp);
-	return min_value;
-}
+	auto heap = v;
+	const double pushes = measure_ms([&] { for (int x : extra) push_heap(heap, x); });
+	heap = v;
+	const double bulk = measure_ms([&] { heap_bulk_insert(heap, extra.begin(), extra.end()); });
+	if (!is_min_heap(heap) || heap.size() != n + extra.size())
+		std::cout << "Error: heap_bulk_insert\n";
+	std::cout << "inserting " << extra.size() << ": push_heap " << pushes << " ms, heap_bulk_insert " << bulk << " ms\n";
 
-size_t round_down_pow2(size_t x)
-{
-	x = x | (x >> 1);
-	x = x | (x >> 2);
-	x = x | (x >> 4);
-	x = x | (x >> 8);
-	x = x | (x >> 16);
-	x = x | (x >> 32);
-	return (x + 1) >> 1;
+	std::pmr::vector<int> left(v0.begin(), v0.begin() + n / 2), right(v0.begin() + n / 2, v0.end());
+	make_heap(left);
+	make_heap(right);
+	const double merge = measure_ms([&] { heap_merge(left, std::move(right)); });
+	if (!is_min_heap(left) || left.size() != n || !right.empty())
+		std::cout << "Error: heap_merge\n";
+	std::cout << "merging two heaps of " << n / 2 << ": heap_merge " << merge << " ms\n";
 }
 
-template<class T, class Comp = std::less<T>>
-void make_heap(std::pmr::vector<T>& arr, Comp&& comp = {})
+//Counts allocations reaching the upstream resource
+class counting_resource : public std::pmr::memory_resource
 {
-	const size_t N = arr.size();
-	const size_t lim = round_down_pow2(N);
-	if (lim == 0)
-		return;
-	for (size_t i = lim - 1; i != -1; --i)
+	std::pmr::memory_resource* m_upstream = std::pmr::new_delete_resource();
+
+	void* do_allocate(size_t bytes, size_t alignment) override
 	{
-		sift_down(arr, i, arr.size(), comp);
+		++allocations;
+		return m_upstream->allocate(bytes, alignment);
 	}
-}
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override
+	{
+		m_upstream->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+
+public:
+	size_t allocations = 0;
+};
 
-template<class T, class Comp = std::less<T>>
-void heap_sort(std::pmr::vector<T>& arr, Comp&& comp = {})
+//Upstream allocations while draining a queue with a shrink policy. Ratios 1 and 2 would reallocate
+//on nearly every pop and are rejected, larger ones must stay logarithmic in the queue size
+void shrink_benchmark(size_t n)
 {
-	auto inverse_comp = std::not_fn(comp);
-	make_heap(arr, inverse_comp);
-	for (size_t i = arr.size() - 1; i != -1; --i)
+	for (size_t ratio : { 1, 2 })
+	{
+		bool rejected = false;
+		try
+		{
+			heap_queue<int> q(std::pmr::get_default_resource(), {}, heap_shrink_policy{ ratio, 16 });
+		}
+		catch (const std::runtime_error&)
+		{
+			rejected = true;
+		}
+		if (!rejected)
+			std::cout << "Error: shrink ratio " << ratio << " accepted\n";
+	}
+
+	for (size_t ratio : { 3, 4, 8 })
 	{
-		std::swap(arr.front(), arr[i]);
-		sift_down(arr, 0, i, inverse_comp);
+		counting_resource upstream;
+		std::mt19937 engine;
+		heap_queue<int> q(&upstream, {}, heap_shrink_policy{ ratio, 16 });
+		for (size_t i = 0; i < n; ++i)
+			q.push((int)engine());
+
+		const size_t filled_allocations = upstream.allocations;
+		size_t max_capacity = q.capacity();
+		while (!q.empty())
+		{
+			q.pop();
+			max_capacity = std::max(max_capacity, q.capacity());
+		}
+		const size_t allocations = upstream.allocations - filled_allocations;
+
+		std::cout << "draining " << n << " with shrink ratio " << ratio << ": " << allocations << " allocations\n";
+		if (allocations > 2 * size_t(std::bit_width(n)) || max_capacity > std::bit_ceil(n))
+			std::cout << "Error: shrink ratio " << ratio << " reallocates too often\n";
 	}
 }
 
+//Short-lived queues under push/pop churn, as an event scheduler creates them.
+//run_queues(upstream, lifetime, queues, initial) creates the queues on its resource and runs lifetime(queue) on each
+template<class RunQueues>
+void churn_benchmark(const char* name, RunQueues&& run_queues)
+{
+	constexpr size_t queues = 200'000;
+	constexpr size_t initial = 48;
+	constexpr size_t churn = 64;
+
+	counting_resource upstream;
+	std::mt19937 engine;
+	bool ordered = true;
+
+	//Every popped element must not be greater than the new top
+	auto checked_pop = [&](heap_queue<int>& q)
+	{
+		const int x = q.pop();
+		if (!q.empty() && q.top() < x)
+			ordered = false;
+	};
+
+	const auto t1 = std::chrono::steady_clock::now();
+	run_queues(upstream, [&](heap_queue<int>& q)
+	{
+		for (size_t i = 0; i < initial; ++i)
+			q.push((int)engine());
+		for (size_t i = 0; i < churn; ++i)
+		{
+			checked_pop(q);
+			q.push((int)engine());
+		}
+		while (!q.empty())
+			checked_pop(q);
+	}, queues, initial);
+	const auto t2 = std::chrono::steady_clock::now();
+
+	const double ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / (queues * (2 * initial + 2 * churn));
+	std::cout << name << ": " << ns << " ns per operation, " << double(upstream.allocations) / queues << " upstream allocations per queue\n";
+	if (!ordered)
+		std::cout << "Error: " << name << ": elements popped out of order\n";
+}
 
-int main()
+int main(int argc, char** argv)
 {
 	std::pmr::vector<int> v0, v;
 	std::mt19937_64 engine;
@@ -108,5 +218,70 @@ int main()
 	std::ranges::stable_sort(v);
 	b = std::ranges::is_sorted(v);
 
+	if (!b)
+		std::cout << "Error: not sorted\n";
+
+	bulk_benchmark(argc > 1 ? std::stoull(argv[1]) : 10'000'000);
+	shrink_benchmark(10'000);
+
+	churn_benchmark("new/delete", [](counting_resource& upstream, auto&& lifetime, size_t queues, size_t)
+	{
+		for (size_t i = 0; i < queues; ++i)
+		{
+			heap_queue<int> q(&upstream);
+			lifetime(q);
+		}
+	});
+
+	churn_benchmark("new/delete, reserved", [](counting_resource& upstream, auto&& lifetime, size_t queues, size_t initial)
+	{
+		for (size_t i = 0; i < queues; ++i)
+		{
+			heap_queue<int> q(initial, &upstream);
+			lifetime(q);
+		}
+	});
+
+	churn_benchmark("unsynchronized pool", [](counting_resource& upstream, auto&& lifetime, size_t queues, size_t)
+	{
+		std::pmr::unsynchronized_pool_resource pool(&upstream);
+		for (size_t i = 0; i < queues; ++i)
+		{
+			heap_queue<int> q(&pool);
+			lifetime(q);
+		}
+	});
+
+	churn_benchmark("unsynchronized pool, reserved", [](counting_resource& upstream, auto&& lifetime, size_t queues, size_t initial)
+	{
+		std::pmr::unsynchronized_pool_resource pool(&upstream);
+		for (size_t i = 0; i < queues; ++i)
+		{
+			heap_queue<int> q(initial, &pool);
+			lifetime(q);
+		}
+	});
+
+	churn_benchmark("monotonic on a stack buffer, reserved", [](counting_resource& upstream, auto&& lifetime, size_t queues, size_t initial)
+	{
+		alignas(std::max_align_t) char buffer[4096];
+		for (size_t i = 0; i < queues; ++i)
+		{
+			std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), &upstream);
+			heap_queue<int> q(initial, &arena);
+			lifetime(q);
+		}
+	});
+
+	churn_benchmark("pool with shrink policy", [](counting_resource& upstream, auto&& lifetime, size_t queues, size_t initial)
+	{
+		std::pmr::unsynchronized_pool_resource pool(&upstream);
+		for (size_t i = 0; i < queues; ++i)
+		{
+			heap_queue<int> q(initial, &pool, {}, heap_shrink_policy{ 4, 16 });
+			lifetime(q);
+		}
+	});
+
 	return 0;
 }
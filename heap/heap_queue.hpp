@@ -0,0 +1,140 @@
+#ifndef _HEAP_QUEUE_HPP_
+#define _HEAP_QUEUE_HPP_
+
+#include <vector>
+#include <memory_resource>
+#include <utility>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <stdexcept>
+
+#include "heap.hpp"
+
+
+//When pop() gives memory back: once size * ratio < capacity, capacity drops to twice the size,
+//but never below min_capacity. ratio = 0 never shrinks, which is what monotonic resources want.
+//Other ratios must be above 2, so that the shrunk capacity is below the next trigger and
+//draining a queue reallocates O(log n) times instead of on every pop
+struct heap_shrink_policy
+{
+	size_t ratio = 0;
+	size_t min_capacity = 0;
+};
+
+//Min-priority queue over push_heap/erase_min_heap whose storage comes from a memory_resource.
+//Allocator-aware in the pmr sense: containers of queues pass their resource down
+template<class T, class Comp = std::less<T>>
+class heap_queue
+{
+	std::pmr::vector<T> m_data;
+	[[no_unique_address]] Comp m_comp;
+	heap_shrink_policy m_shrink;
+
+	void shrink_if_sparse()
+	{
+		const size_t capacity = m_data.capacity();
+		if (m_shrink.ratio == 0 || capacity <= m_shrink.min_capacity || m_data.size() * m_shrink.ratio >= capacity)
+			return;
+		reallocate(std::max(m_shrink.min_capacity, 2 * m_data.size()));
+	}
+
+	static heap_shrink_policy checked(heap_shrink_policy shrink)
+	{
+		if (shrink.ratio == 1 || shrink.ratio == 2)
+			throw std::runtime_error("heap_queue: shrink ratio must be 0 or above 2");
+		return shrink;
+	}
+
+	void reallocate(size_t capacity)
+	{
+		std::pmr::vector<T> data(m_data.get_allocator());
+		data.reserve(capacity);
+		std::move(m_data.begin(), m_data.end(), std::back_inserter(data));
+		m_data.swap(data);
+	}
+
+public:
+	using value_type = T;
+	using allocator_type = std::pmr::polymorphic_allocator<T>;
+
+	heap_queue() = default;
+	explicit heap_queue(const allocator_type& alloc, Comp comp = {}, heap_shrink_policy shrink = {})
+		: m_data(alloc), m_comp(std::move(comp)), m_shrink(checked(shrink)) {}
+	heap_queue(size_t reserved, const allocator_type& alloc, Comp comp = {}, heap_shrink_policy shrink = {})
+		: heap_queue(alloc, std::move(comp), shrink)
+	{
+		m_data.reserve(reserved);
+	}
+
+	heap_queue(const heap_queue&) = default;
+	heap_queue(heap_queue&&) noexcept = default;
+	heap_queue(const heap_queue& other, const allocator_type& alloc)
+		: m_data(other.m_data, alloc), m_comp(other.m_comp), m_shrink(other.m_shrink) {}
+	heap_queue(heap_queue&& other, const allocator_type& alloc)
+		: m_data(std::move(other.m_data), alloc), m_comp(std::move(other.m_comp)), m_shrink(other.m_shrink) {}
+
+	heap_queue& operator=(const heap_queue&) = default;
+	heap_queue& operator=(heap_queue&&) = default;
+
+	allocator_type get_allocator() const noexcept
+	{
+		return m_data.get_allocator();
+	}
+
+	bool empty() const noexcept
+	{
+		return m_data.empty();
+	}
+	size_t size() const noexcept
+	{
+		return m_data.size();
+	}
+	size_t capacity() const noexcept
+	{
+		return m_data.capacity();
+	}
+
+	const T& top() const
+	{
+		return m_data.front();
+	}
+
+	void push(const T& x)
+	{
+		push_heap(m_data, x, m_comp);
+	}
+	void push(T&& x)
+	{
+		push_heap(m_data, std::move(x), m_comp);
+	}
+
+	T pop()
+	{
+		T result = erase_min_heap(m_data, m_comp);
+		shrink_if_sparse();
+		return result;
+	}
+
+	void reserve(size_t n)
+	{
+		m_data.reserve(n);
+	}
+	void shrink_to_fit()
+	{
+		if (m_data.capacity() != m_data.size())
+			reallocate(m_data.size());
+	}
+	void set_shrink_policy(heap_shrink_policy shrink)
+	{
+		m_shrink = checked(shrink);
+	}
+
+	//Keeps the capacity, so a queue reused from a pool doesn't allocate again
+	void clear() noexcept
+	{
+		m_data.clear();
+	}
+};
+
+#endif //!_HEAP_QUEUE_HPP_
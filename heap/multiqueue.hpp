@@ -0,0 +1,237 @@
+#ifndef _MULTIQUEUE_HPP_
+#define _MULTIQUEUE_HPP_
+
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <new>
+
+#include <stdint.h>
+
+#include "heap.hpp"
+
+
+//Options of multiqueue. More pop_choices sample more heaps per pop and give a stricter order:
+//2 is the classic MultiQueue, queues makes every pop exact at the price of locking all heaps at once
+struct multiqueue_options
+{
+	size_t queues = 0; //0 = twice the hardware concurrency
+	size_t pop_choices = 2;
+	size_t push_batch_chunk = 16; //Elements of a batch pushed under one lock
+};
+
+//Relaxed concurrent min-priority queue: a MultiQueue of heaps, each behind its own lock.
+//push locks a random heap, pop locks the heap with the smallest top among pop_choices random ones.
+//Locks are tried first, so a contended heap is usually skipped instead of waited for: push blocks only after
+//a few busy heaps in a row, pop only once sampling found nothing or when every heap is locked for an exact pop.
+//Elements come out roughly, not exactly, in order: the expected rank error grows with queues / pop_choices,
+//and is only 0 for pop_choices = queues
+template<class T, class Comp = std::less<T>>
+class multiqueue
+{
+	struct alignas(64) lane
+	{
+		std::mutex lock;
+		std::pmr::vector<T> heap;
+		std::atomic<size_t> size = 0;
+	};
+
+	std::unique_ptr<lane[]> m_lanes;
+	size_t m_queues;
+	size_t m_choices;
+	size_t m_chunk;
+	[[no_unique_address]] Comp m_comp;
+
+	static uint64_t random()
+	{
+		static std::atomic<uint64_t> seed_source = 0x9E3779B97F4A7C15;
+		thread_local uint64_t state = seed_source.fetch_add(0x9E3779B97F4A7C15, std::memory_order_relaxed) | 1;
+
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return state;
+	}
+
+	lane& random_lane()
+	{
+		return m_lanes[random() % m_queues];
+	}
+
+	//Locks a random heap, trying others while they are busy. Waits on the last one after a few failures,
+	//so that producers don't spin when there are few heaps
+	std::unique_lock<std::mutex> lock_any(lane*& result)
+	{
+		static constexpr size_t max_tries = 8;
+
+		for (size_t i = 0; i < max_tries; ++i)
+		{
+			result = &random_lane();
+			std::unique_lock guard(result->lock, std::try_to_lock);
+			if (guard.owns_lock())
+				return guard;
+		}
+		return std::unique_lock(result->lock);
+	}
+
+	//Exact pop: locks every heap in index order, so that concurrent exact pops can't deadlock,
+	//and keeps the lock of the one with the smallest top. No lock is held if all heaps are empty
+	std::unique_lock<std::mutex> lock_min(lane*& best)
+	{
+		best = nullptr;
+		for (size_t i = 0; i < m_queues; ++i)
+			m_lanes[i].lock.lock();
+
+		for (size_t i = 0; i < m_queues; ++i)
+		{
+			lane& candidate = m_lanes[i];
+			if (!candidate.heap.empty() && (!best || m_comp(candidate.heap.front(), best->heap.front())))
+				best = &candidate;
+		}
+
+		for (size_t i = 0; i < m_queues; ++i)
+			if (&m_lanes[i] != best)
+				m_lanes[i].lock.unlock();
+		return best ? std::unique_lock<std::mutex>(best->lock, std::adopt_lock) : std::unique_lock<std::mutex>();
+	}
+
+	//Locks the non-empty heap with the smallest top among m_choices random ones, or among all heaps if m_choices == m_queues.
+	//No lock is held on failure, which means every sampled heap was empty or busy
+	std::unique_lock<std::mutex> lock_best(lane*& best)
+	{
+		if (m_choices == m_queues)
+			return lock_min(best);
+
+		std::unique_lock<std::mutex> best_guard;
+		best = nullptr;
+
+		for (size_t i = 0; i < m_choices; ++i)
+		{
+			lane& candidate = random_lane();
+			if (&candidate == best || candidate.size.load(std::memory_order_relaxed) == 0)
+				continue;
+
+			std::unique_lock guard(candidate.lock, std::try_to_lock);
+			if (!guard.owns_lock() || candidate.heap.empty())
+				continue;
+
+			if (!best || m_comp(candidate.heap.front(), best->heap.front()))
+			{
+				best = &candidate;
+				best_guard = std::move(guard);
+			}
+		}
+		return best_guard;
+	}
+
+	//Blocking sweep used once sampling came back empty handed, so that pop only fails when the queue is empty
+	std::unique_lock<std::mutex> lock_any_nonempty(lane*& result)
+	{
+		for (size_t i = 0; i < m_queues; ++i)
+		{
+			result = &m_lanes[i];
+			if (result->size.load(std::memory_order_relaxed) == 0)
+				continue;
+			std::unique_lock guard(result->lock);
+			if (!result->heap.empty())
+				return guard;
+		}
+		result = nullptr;
+		return {};
+	}
+
+	T pop_locked(lane& l)
+	{
+		T x = erase_min_heap(l.heap, m_comp);
+		l.size.store(l.heap.size(), std::memory_order_relaxed);
+		return x;
+	}
+
+public:
+	explicit multiqueue(multiqueue_options options = {}, Comp comp = {})
+		: m_comp(std::move(comp))
+	{
+		m_queues = options.queues ? options.queues : 2 * std::max<size_t>(1, std::thread::hardware_concurrency());
+		m_choices = std::clamp<size_t>(options.pop_choices, 1, m_queues);
+		m_chunk = std::max<size_t>(1, options.push_batch_chunk);
+		m_lanes = std::make_unique<lane[]>(m_queues);
+	}
+
+	size_t queues() const noexcept
+	{
+		return m_queues;
+	}
+
+	//Snapshot, only exact while no other thread works on the queue
+	size_t size() const noexcept
+	{
+		size_t result = 0;
+		for (size_t i = 0; i < m_queues; ++i)
+			result += m_lanes[i].size.load(std::memory_order_relaxed);
+		return result;
+	}
+
+	void push(T x)
+	{
+		lane* l;
+		const auto guard = lock_any(l);
+		push_heap(l->heap, std::move(x), m_comp);
+		l->size.store(l->heap.size(), std::memory_order_relaxed);
+	}
+
+	//Pushes [first; last) in chunks of push_batch_chunk elements, each chunk into one random heap
+	template<std::input_iterator Iter, std::sentinel_for<Iter> Sentinel>
+	void push_batch(Iter first, Sentinel last)
+	{
+		while (first != last)
+		{
+			lane* l;
+			const auto guard = lock_any(l);
+			for (size_t i = 0; i < m_chunk && first != last; ++i, ++first)
+				push_heap(l->heap, T(*first), m_comp);
+			l->size.store(l->heap.size(), std::memory_order_relaxed);
+		}
+	}
+
+	//Empty only if the queue was observed empty
+	std::optional<T> try_pop()
+	{
+		lane* l;
+		auto guard = lock_best(l);
+		if (!l)
+			guard = lock_any_nonempty(l);
+		if (!l)
+			return std::nullopt;
+		return pop_locked(*l);
+	}
+
+	//Pops up to max_count elements from the chosen heap into out. Returns the number popped, 0 if the queue was observed empty.
+	//The elements are the smallest of their heap, so the relaxation grows with max_count
+	template<std::output_iterator<T> Out>
+	size_t try_pop_batch(Out out, size_t max_count)
+	{
+		if (max_count == 0)
+			return 0;
+
+		lane* l;
+		auto guard = lock_best(l);
+		if (!l)
+			guard = lock_any_nonempty(l);
+		if (!l)
+			return 0;
+
+		size_t count = 0;
+		for (; count < max_count && !l->heap.empty(); ++count)
+			*out++ = pop_locked(*l);
+		return count;
+	}
+};
+
+#endif //!_MULTIQUEUE_HPP_
@@ -0,0 +1,179 @@
+
+#include "multiqueue.hpp"
+#include "heap_queue.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <optional>
+#include <algorithm>
+#include <string>
+#include <cmath>
+
+
+//Baseline: one heap behind one lock
+class locked_heap
+{
+	std::mutex m_lock;
+	heap_queue<uint64_t> m_heap;
+
+public:
+	void push(uint64_t x)
+	{
+		std::lock_guard guard(m_lock);
+		m_heap.push(x);
+	}
+
+	std::optional<uint64_t> try_pop()
+	{
+		std::lock_guard guard(m_lock);
+		if (m_heap.empty())
+			return std::nullopt;
+		return m_heap.pop();
+	}
+};
+
+struct checksum
+{
+	uint64_t count = 0, sum = 0, xor_sum = 0;
+
+	void add(uint64_t x)
+	{
+		++count;
+		sum += x;
+		xor_sum ^= x;
+	}
+	void merge(const checksum& other)
+	{
+		count += other.count;
+		sum += other.sum;
+		xor_sum ^= other.xor_sum;
+	}
+	bool operator==(const checksum&) const = default;
+};
+
+//Every thread pushes ops elements and pops as many, then the queue is drained.
+//Fails if the popped elements differ from the pushed ones
+template<class Queue>
+void throughput(const char* name, Queue& queue, size_t threads, size_t ops, size_t batch = 1)
+{
+	std::vector<checksum> pushed(threads), popped(threads);
+
+	const auto t1 = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (size_t t = 0; t < threads; ++t)
+	{
+		workers.emplace_back([&, t]
+		{
+			std::mt19937_64 rng(t);
+			std::vector<uint64_t> buffer;
+			for (size_t done = 0; done < ops; done += batch)
+			{
+				buffer.clear();
+				for (size_t i = 0; i < batch; ++i)
+				{
+					buffer.push_back(rng() >> 1);
+					pushed[t].add(buffer.back());
+				}
+
+				if constexpr (requires { queue.push_batch(buffer.begin(), buffer.end()); })
+				{
+					queue.push_batch(buffer.begin(), buffer.end());
+					buffer.clear();
+					queue.try_pop_batch(std::back_inserter(buffer), batch);
+					for (uint64_t x : buffer)
+						popped[t].add(x);
+				}
+				else
+				{
+					for (uint64_t x : buffer)
+						queue.push(x);
+					for (size_t i = 0; i < batch; ++i)
+						if (auto x = queue.try_pop())
+							popped[t].add(*x);
+				}
+			}
+		});
+	}
+	for (auto& worker : workers)
+		worker.join();
+	const auto t2 = std::chrono::steady_clock::now();
+
+	checksum all_pushed, all_popped;
+	for (size_t t = 0; t < threads; ++t)
+	{
+		all_pushed.merge(pushed[t]);
+		all_popped.merge(popped[t]);
+	}
+	while (auto x = queue.try_pop())
+		all_popped.add(*x);
+
+	const double ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / (2 * threads * ops);
+	std::cout << std::setw(36) << name << ": " << std::setw(8) << ns << " ns per operation\n";
+	if (all_pushed != all_popped)
+		std::cout << "Error: " << name << " lost or duplicated elements\n";
+}
+
+//Mean distance between the position of each element in the pop order and its rank, from a full queue
+void rank_error(size_t queues, size_t choices, size_t n)
+{
+	multiqueue<uint64_t> queue({ queues, choices });
+	std::mt19937_64 rng;
+	for (size_t i = 0; i < n; ++i)
+		queue.push(rng());
+
+	std::vector<uint64_t> order;
+	while (auto x = queue.try_pop())
+		order.push_back(*x);
+
+	auto sorted = order;
+	std::ranges::sort(sorted);
+	double error = 0;
+	for (size_t i = 0; i < order.size(); ++i)
+		error += std::abs(double(std::ranges::lower_bound(sorted, order[i]) - sorted.begin()) - double(i));
+
+	std::cout << std::setw(3) << queues << " heaps, " << choices << " choices: mean rank error " << error / n << '\n';
+	if (order.size() != n)
+		std::cout << "Error: multiqueue lost elements\n";
+	if (choices >= queues && error != 0)
+		std::cout << "Error: multiqueue with pop_choices = queues popped out of order\n";
+}
+
+int main(int argc, char** argv)
+{
+	const size_t threads = argc > 1 ? std::stoull(argv[1]) : std::max<size_t>(4, std::thread::hardware_concurrency());
+	const size_t ops = argc > 2 ? std::stoull(argv[2]) : 1'000'000;
+
+	std::cout << threads << " threads, " << ops << " pushes and pops each\n";
+	{
+		locked_heap queue;
+		throughput("single heap behind a mutex", queue, threads, ops);
+	}
+	for (size_t choices : { 2, 4 })
+	{
+		multiqueue<uint64_t> queue({ 2 * threads, choices });
+		const std::string name = "multiqueue, " + std::to_string(choices) + " choices";
+		throughput(name.c_str(), queue, threads, ops);
+	}
+	{
+		multiqueue<uint64_t> queue({ 2 * threads, 2 });
+		throughput("multiqueue, batches of 16", queue, threads, ops, 16);
+	}
+	{
+		multiqueue<uint64_t> queue({ 2 * threads, 2 * threads });
+		throughput("multiqueue, exact", queue, threads, ops);
+	}
+	{
+		multiqueue<uint64_t> queue({ 1, 1 });
+		throughput("multiqueue, one heap", queue, threads, ops);
+	}
+
+	for (size_t choices : { 1, 2, 4, 16 })
+		rank_error(16, choices, 100'000);
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+#ifndef _PARALLEL_HEAP_HPP_
+#define _PARALLEL_HEAP_HPP_
+
+#include <vector>
+#include <memory_resource>
+#include <thread>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <utility>
+
+#include "heap.hpp"
+
+
+//Floyd's heap construction split between threads. Subtrees rooted at one level are independent,
+//so the threads heapify whole subtrees below that level, each bottom-up level by level,
+//and the few nodes above it are sifted down on the calling thread
+template<class T, class Comp = std::less<T>>
+void parallel_make_heap(std::pmr::vector<T>& arr, Comp&& comp = {}, size_t threads = 0)
+{
+	static constexpr size_t min_elements_per_thread = 1 << 16;
+	static constexpr size_t subtrees_per_thread = 8;
+
+	const size_t N = arr.size();
+	if (threads == 0)
+		threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	threads = std::clamp<size_t>(N / min_elements_per_thread, 1, threads);
+	if (threads == 1)
+		return make_heap(arr, comp);
+
+	//Nodes of level split are the subtree roots
+	size_t split = 0;
+	while ((size_t(1) << split) < threads * subtrees_per_thread)
+		++split;
+	const size_t roots_begin = (size_t(1) << split) - 1;
+	const size_t roots = size_t(1) << split;
+
+	auto heapify_subtree = [&](size_t root)
+	{
+		//The subtree's nodes at depth d below root are [(root + 1) * 2^d - 1; (root + 2) * 2^d - 1)
+		size_t depth = 0;
+		while (((root + 1) << (depth + 1)) - 1 < N)
+			++depth;
+		for (size_t d = depth + 1; d-- > 0; )
+		{
+			const size_t begin = ((root + 1) << d) - 1;
+			const size_t end = std::min(N, ((root + 2) << d) - 1);
+			for (size_t i = end; i-- > begin; )
+				sift_down(arr, i, N, comp);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	workers.reserve(threads - 1);
+	auto job = [&](size_t t)
+	{
+		for (size_t r = roots * t / threads; r < roots * (t + 1) / threads; ++r)
+			if (roots_begin + r < N)
+				heapify_subtree(roots_begin + r);
+	};
+	for (size_t t = 1; t < threads; ++t)
+		workers.emplace_back(job, t);
+	job(0);
+	for (auto& worker : workers)
+		worker.join();
+
+	for (size_t i = std::min(roots_begin, N); i-- > 0; )
+		sift_down(arr, i, N, comp);
+}
+
+//Restores the heap after elements were appended at [first_new; arr.size()). Only the ancestors of the new
+//elements can break the heap property, and they form one contiguous range per level, fixed bottom-up:
+//O(k + log(k) * log(n)) for k new elements instead of O(k * log(n)) pushes
+template<class T, class Comp = std::less<T>>
+void heap_fix_appended(std::pmr::vector<T>& arr, size_t first_new, Comp&& comp = {})
+{
+	const size_t N = arr.size();
+	if (first_new >= N || N <= 1)
+		return;
+
+	size_t begin = first_new, end = N - 1;
+	if (begin == 0)
+		begin = 1;
+	while (true)
+	{
+		begin = (begin - 1) / 2;
+		end = (end - 1) / 2;
+		for (size_t i = end + 1; i-- > begin; )
+			sift_down(arr, i, N, comp);
+		if (begin == 0)
+			break;
+	}
+}
+
+//Appends [first; last) to the heap
+template<class T, std::input_iterator Iter, std::sentinel_for<Iter> Sentinel, class Comp = std::less<T>>
+void heap_bulk_insert(std::pmr::vector<T>& arr, Iter first, Sentinel last, Comp&& comp = {})
+{
+	const size_t first_new = arr.size();
+	arr.insert(arr.end(), first, last);
+	heap_fix_appended(arr, first_new, comp);
+}
+
+//Moves the elements of heap other into heap arr, other is left empty.
+//The smaller heap is appended to the larger one, whose storage is kept when both share a memory resource
+template<class T, class Comp = std::less<T>>
+void heap_merge(std::pmr::vector<T>& arr, std::pmr::vector<T>&& other, Comp&& comp = {})
+{
+	if (other.size() > arr.size() && arr.get_allocator() == other.get_allocator())
+		arr.swap(other);
+
+	const size_t first_new = arr.size();
+	arr.insert(arr.end(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+	other.clear();
+	heap_fix_appended(arr, first_new, comp);
+}
+
+#endif //!_PARALLEL_HEAP_HPP_
@@ -3,6 +3,7 @@
 #include <chrono>
 #include <random>
 #include <iostream>
+#include <iomanip>
 
 #include "radix_sort.hpp"
 
@@ -10,9 +10,17 @@
 #include <utility>
 #include <algorithm>
 #include <numeric>
+#include <bit>
+#include <iterator>
+#include <type_traits>
+
+#include <limits.h>
 
 #include <ksn/ksn.hpp>
 
+#include "../sort_perf/sort_perf.hpp"
+#include "../sort_tuning/sort_tuning.hpp"
+
 
 _KSN_BEGIN
 
@@ -30,7 +38,7 @@ static uint8_t _radix_sort_log(T max, uint8_t base_log2)
 	return result;
 }
 
-static constexpr uint8_t _radix_sort_max_base_log = 8;
+static constexpr uint8_t _radix_sort_max_base_log = sort_tuning::radix_sort_max_base_log2;
 
 template<class T>
 struct _radix_sort_data_t
@@ -59,7 +67,7 @@ void _radix_sort_based(Iter begin, Iter end, uint8_t base_log2, uint8_t iteratio
 	static thread_local size_t counts[1 << _radix_sort_max_base_log];
 	auto& aux = _radix_sort_data<T>.auxillary;
 
-	size_t n = end - begin;
+	[[maybe_unused]] const size_t n = end - begin; //Only read by the KSN_SORT_PERF counters
 
 	RSIter rbegin;
 	RSIter rend;
@@ -89,16 +97,22 @@ void _radix_sort_based(Iter begin, Iter end, uint8_t base_log2, uint8_t iteratio
 	{
 		memset(counts, 0, sizeof(counts[0]) * base);
 
-		auto main_begin = main_span.begin();
-		auto main_end = main_span.end();
-
-		for (auto&& x : main_span)
-			++counts[classify(x)];
+		{
+			_KSN_SORT_PERF_SCOPE(sort_perf::phase::histogram, (size_t)(shift / base_log2), n * sizeof(T));
+			for (auto&& x : main_span)
+				++counts[classify(x)];
+		}
 
-		std::partial_sum(counts + 0, counts + base, counts + 0);
+		{
+			_KSN_SORT_PERF_SCOPE(sort_perf::phase::prefix_sum, (size_t)(shift / base_log2), 0);
+			std::partial_sum(counts + 0, counts + base, counts + 0);
+		}
 		
-		for (auto p = rbegin; p != rend; ++p)
-			aux_span[--counts[classify(*p)]] = std::move(*p);
+		{
+			_KSN_SORT_PERF_SCOPE(sort_perf::phase::permute, (size_t)(shift / base_log2), 2 * n * sizeof(T));
+			for (auto p = rbegin; p != rend; ++p)
+				aux_span[--counts[classify(*p)]] = std::move(*p);
+		}
 
 		swap_buffers();
 
@@ -109,7 +123,10 @@ void _radix_sort_based(Iter begin, Iter end, uint8_t base_log2, uint8_t iteratio
 	}
 
 	if (buffer_swap_parity != 0)
+	{
+		_KSN_SORT_PERF_SCOPE(sort_perf::phase::copy, 2 * n * sizeof(T));
 		std::ranges::copy(main_span, aux_span.begin());
+	}
 }
 
 
@@ -130,10 +147,11 @@ void ensure_vector_size(T& v, size_t n)
 template<class T>
 std::pair<uint8_t, uint8_t> _radix_sort_get_optimal_base(const T& max, size_t n)
 {
-	if (max < (1 << _radix_sort_max_base_log))
+	const uint8_t base_log = sort_tuning::get(sizeof(T), n).radix_sort_base_log2;
+	if (uint64_t(max) < (uint64_t(1) << base_log))
 		return { _radix_sort_log(max, 1) + 1 , 1 };
 	else
-		return { _radix_sort_max_base_log, _radix_sort_log(max, _radix_sort_max_base_log) + 1 };
+		return { base_log, _radix_sort_log(max, base_log) + 1 };
 }
 
 _KSN_DETAIL_END
@@ -168,6 +186,144 @@ void radix_sort(Iter begin, Iter end) noexcept
 		detail::reconstruct(detail::_radix_sort_data<T>.auxillary);
 }
 
+
+
+_KSN_DETAIL_BEGIN
+
+//Compile-time pass plan of radix_sort<KeyBits, DigitBits>
+template<size_t KeyBits, size_t DigitBits>
+struct _radix_sort_plan
+{
+	static constexpr size_t passes = (KeyBits + DigitBits - 1) / DigitBits;
+	static constexpr size_t buckets = size_t(1) << DigitBits;
+
+	static constexpr size_t shift(size_t pass)
+	{
+		return pass * DigitBits;
+	}
+
+	//The last pass may be narrower than DigitBits
+	static constexpr size_t mask(size_t pass)
+	{
+		const size_t bits = std::min(DigitBits, KeyBits - pass * DigitBits);
+		return (size_t(1) << bits) - 1;
+	}
+};
+
+//Keys as unsigned values, signed full-width keys get their sign bit flipped to keep the order
+template<size_t KeyBits, std::integral T>
+constexpr std::make_unsigned_t<T> _radix_sort_key(T x) noexcept
+{
+	using U = std::make_unsigned_t<T>;
+	if constexpr (std::is_signed_v<T> && KeyBits == sizeof(T) * CHAR_BIT)
+		return U(x) ^ (U(1) << (KeyBits - 1));
+	else
+		return U(x);
+}
+
+inline thread_local std::vector<size_t> _radix_sort_fixed_counts;
+
+_KSN_DETAIL_END
+
+//LSD radix sort of integers whose keys fit in the low KeyBits bits, with the pass plan fixed at compile time.
+//Signed keys must use the full width of the type.
+//Histograms of all passes are taken in one sweep, and passes where every element has the same digit are skipped.
+//With MinMax, a min/max scan first drops the passes above the highest bit that differs between the keys
+template<size_t KeyBits, size_t DigitBits = 8, bool MinMax = false, std::contiguous_iterator Iter>
+void radix_sort(Iter begin, Iter end) noexcept
+{
+	using T = std::iter_value_t<Iter>;
+	using U = std::make_unsigned_t<T>;
+	using plan = detail::_radix_sort_plan<KeyBits, DigitBits>;
+
+	static_assert(std::integral<T>, "radix_sort<KeyBits, DigitBits>: integral keys only");
+	static_assert(KeyBits >= 1 && KeyBits <= sizeof(T) * CHAR_BIT, "radix_sort<KeyBits, DigitBits>: KeyBits exceeds the key type");
+	static_assert(!std::is_signed_v<T> || KeyBits == sizeof(T) * CHAR_BIT, "radix_sort<KeyBits, DigitBits>: signed keys must be full width");
+	static_assert(DigitBits >= 1 && DigitBits <= 16, "radix_sort<KeyBits, DigitBits>: DigitBits must be in [1; 16]");
+
+	const size_t n = end - begin;
+	if (n <= 1)
+		return;
+
+	T* const data = std::to_address(begin);
+	auto key = [](T x) { return detail::_radix_sort_key<KeyBits>(x); };
+
+	size_t active_passes = plan::passes;
+	if constexpr (MinMax)
+	{
+		U min = key(data[0]), max = min;
+		for (size_t i = 1; i < n; ++i)
+		{
+			const U k = key(data[i]);
+			min = std::min(min, k);
+			max = std::max(max, k);
+		}
+
+		//Keys in [min; max] share every bit above the highest bit where min and max differ
+		const U differing = min ^ max;
+		if (differing == 0)
+			return;
+		active_passes = std::min<size_t>(plan::passes, std::bit_width(differing) / DigitBits + bool(std::bit_width(differing) % DigitBits));
+	}
+
+	auto& counts = detail::_radix_sort_fixed_counts;
+	counts.assign(plan::passes * plan::buckets, 0);
+
+	{
+		_KSN_SORT_PERF_SCOPE(sort_perf::phase::histogram, 0, n * sizeof(T));
+		for (size_t i = 0; i < n; ++i)
+		{
+			const U k = key(data[i]);
+			[&]<size_t... P>(std::index_sequence<P...>)
+			{
+				((P < active_passes ? (void)++counts[P * plan::buckets + ((k >> plan::shift(P)) & plan::mask(P))] : (void)0), ...);
+			}(std::make_index_sequence<plan::passes>{});
+		}
+	}
+
+	auto& aux = detail::_radix_sort_data<T>.auxillary;
+	detail::ensure_vector_size(aux, n);
+
+	T* src = data;
+	T* dst = aux.data();
+
+	auto pass = [&]<size_t P>(std::integral_constant<size_t, P>)
+	{
+		if (P >= active_passes)
+			return;
+
+		size_t* const count = counts.data() + P * plan::buckets;
+		if (count[(key(src[0]) >> plan::shift(P)) & plan::mask(P)] == n)
+			return;
+
+		{
+			_KSN_SORT_PERF_SCOPE(sort_perf::phase::prefix_sum, P, 0);
+			std::exclusive_scan(count, count + plan::buckets, count, size_t(0));
+		}
+
+		{
+			_KSN_SORT_PERF_SCOPE(sort_perf::phase::permute, P, 2 * n * sizeof(T));
+			for (size_t i = 0; i < n; ++i)
+				dst[count[(key(src[i]) >> plan::shift(P)) & plan::mask(P)]++] = std::move(src[i]);
+		}
+		std::swap(src, dst);
+	};
+
+	[&]<size_t... P>(std::index_sequence<P...>)
+	{
+		(pass(std::integral_constant<size_t, P>{}), ...);
+	}(std::make_index_sequence<plan::passes>{});
+
+	if (src != data)
+	{
+		_KSN_SORT_PERF_SCOPE(sort_perf::phase::copy, 2 * n * sizeof(T));
+		std::copy(src, src + n, data);
+	}
+
+	if (detail::_radix_sort_data<T>.always_free_auxillary)
+		detail::reconstruct(aux);
+}
+
 _KSN_END
 
 
@@ -0,0 +1,126 @@
+
+#ifndef _KSN_RADIX_SORT_IN_PLACE_HPP_
+#define _KSN_RADIX_SORT_IN_PLACE_HPP_
+
+//In-place MSD radix sort with 8-bit digits, the 1x memory counterpart of radix_sort.
+//Every level partitions its range with the afsort cycle-swap kernel and recurses into the buckets,
+//so the extra memory is two bucket arrays per level: at most sizeof(T) levels, independent of n.
+//It starts at the highest byte where the smallest and the largest key differ,
+//and ranges below a small cutoff are insertion sorted
+
+#include <concepts>
+#include <iterator>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <type_traits>
+
+#include <limits.h>
+
+#include <ksn/ksn.hpp>
+
+#include "../american_flag_sort/radix_partition.hpp"
+#include "radix_sort.hpp"
+
+
+_KSN_BEGIN
+
+_KSN_DETAIL_BEGIN
+
+static constexpr size_t _radix_sort_in_place_cutoff = 32;
+
+//Sorts [arr; arr + n) whose keys agree above the byte at shift. Keys are left-aligned in U,
+//last_shift is the shift of the lowest byte that still holds key bits
+template<size_t KeyBits, class Iter, class size_type>
+void _radix_sort_in_place_impl(Iter arr, size_type n, int shift, int last_shift) noexcept
+{
+	using T = std::iter_value_t<Iter>;
+	using U = std::make_unsigned_t<T>;
+	static constexpr int align = sizeof(U) * CHAR_BIT - KeyBits;
+
+	if (n <= _radix_sort_in_place_cutoff)
+	{
+		for (size_type i = 1; i < n; ++i)
+		{
+			T x = std::move(arr[i]);
+			size_type j = i;
+			for (; j > 0 && _radix_sort_key<KeyBits>(x) < _radix_sort_key<KeyBits>(arr[j - 1]); --j)
+				arr[j] = std::move(arr[j - 1]);
+			arr[j] = std::move(x);
+		}
+		return;
+	}
+
+	std::array<size_type, 256> bucket_begins, bucket_ends;
+	auto digit = [shift](const T& x)
+	{
+		return size_t(U(_radix_sort_key<KeyBits>(x) << align) >> shift) & 0xFF;
+	};
+	_radix_partition_in_place(arr, n, digit, 256, bucket_begins.data(), bucket_ends.data());
+
+	if (shift == last_shift)
+		return;
+
+	_KSN_SORT_PERF_SCOPE(sort_perf::phase::recursion);
+	for (size_t b = 0; b < 256; ++b)
+	{
+		const size_type end = b + 1 < 256 ? bucket_begins[b + 1] : n;
+		if (end - bucket_begins[b] > 1)
+			_radix_sort_in_place_impl<KeyBits>(arr + bucket_begins[b], size_type(end - bucket_begins[b]), shift - CHAR_BIT, last_shift);
+	}
+}
+
+_KSN_DETAIL_END
+
+//In-place MSD radix sort of integers whose keys fit in the low KeyBits bits, signed keys must use the full width.
+//Needs no buffer proportional to n, not stable
+template<size_t KeyBits, std::random_access_iterator Iter>
+void radix_sort_in_place(Iter begin, Iter end) noexcept
+{
+	using T = std::iter_value_t<Iter>;
+	using U = std::make_unsigned_t<T>;
+
+	static_assert(std::integral<T>, "radix_sort_in_place: integral keys only");
+	static_assert(KeyBits >= 1 && KeyBits <= sizeof(T) * CHAR_BIT, "radix_sort_in_place: KeyBits exceeds the key type");
+	static_assert(!std::is_signed_v<T> || KeyBits == sizeof(T) * CHAR_BIT, "radix_sort_in_place: signed keys must be full width");
+
+	static constexpr int width = sizeof(U) * CHAR_BIT;
+	static constexpr int align = width - KeyBits;
+
+	const size_t n = end - begin;
+	if (n <= 1)
+		return;
+
+	auto key = [](const T& x) { return U(detail::_radix_sort_key<KeyBits>(x) << align); };
+
+	U min = key(begin[0]), max = min;
+	for (size_t i = 1; i < n; ++i)
+	{
+		const U k = key(begin[i]);
+		min = std::min(min, k);
+		max = std::max(max, k);
+	}
+
+	//Bytes above the highest differing bit of min and max are the same for every key
+	const U differing = min ^ max;
+	if (differing == 0)
+		return;
+	const int shift = (std::bit_width(differing) - 1) / CHAR_BIT * CHAR_BIT;
+	const int last_shift = align / CHAR_BIT * CHAR_BIT;
+
+	if (n <= UINT32_MAX)
+		detail::_radix_sort_in_place_impl<KeyBits>(begin, (uint32_t)n, shift, last_shift);
+	else
+		detail::_radix_sort_in_place_impl<KeyBits>(begin, n, shift, last_shift);
+}
+
+template<std::random_access_iterator Iter>
+void radix_sort_in_place(Iter begin, Iter end) noexcept
+{
+	radix_sort_in_place<sizeof(std::iter_value_t<Iter>) * CHAR_BIT>(begin, end);
+}
+
+_KSN_END
+
+
+#endif //!_KSN_RADIX_SORT_IN_PLACE_HPP_
@@ -0,0 +1,272 @@
+
+#ifndef _KSN_RELATIONAL_HPP_
+#define _KSN_RELATIONAL_HPP_
+
+//Sort-based relational operators on integer key columns: group-by with aggregation, unique with counts,
+//and merge-join. They run an LSD radix sort over (key, payload) records and do their own work in its last pass:
+//the histograms of all passes are taken while the records are gathered, and the group-by aggregates while
+//scattering the last digit, since every bucket then receives its elements in key order
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <numeric>
+#include <concepts>
+#include <type_traits>
+#include <stdexcept>
+
+#include <stdint.h>
+#include <limits.h>
+
+#include <ksn/ksn.hpp>
+
+#include "../radix_sort/radix_sort.hpp"
+
+
+_KSN_BEGIN
+
+_KSN_DETAIL_BEGIN
+
+struct _relational_no_value {};
+
+template<class K, class V>
+struct _relational_record
+{
+	K key;
+	[[no_unique_address]] V value;
+};
+
+template<std::integral K>
+using _relational_plan = _radix_sort_plan<sizeof(K) * CHAR_BIT, 8>;
+
+template<std::integral K>
+size_t _relational_digit(K key, size_t pass)
+{
+	using plan = _relational_plan<K>;
+	return size_t(_radix_sort_key<sizeof(K) * CHAR_BIT>(key) >> plan::shift(pass)) & plan::mask(pass);
+}
+
+//Gathers records and the histograms of every pass in one sweep
+template<std::integral K, class V, class ValueAt>
+void _relational_gather(std::span<const K> keys, ValueAt&& value_at, _relational_record<K, V>* out, std::vector<size_t>& counts)
+{
+	using plan = _relational_plan<K>;
+	counts.assign(plan::passes * plan::buckets, 0);
+
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		out[i] = { keys[i], value_at(i) };
+		for (size_t pass = 0; pass < plan::passes; ++pass)
+			++counts[pass * plan::buckets + _relational_digit(keys[i], pass)];
+	}
+}
+
+//Runs every pass that actually moves elements but the last one, then hands the last one to
+//last_pass(src, pass, bucket_begins). If all keys are equal, last_pass gets pass = plan::passes and no offsets
+template<std::integral K, class Record, class LastPass>
+void _relational_radix_passes(Record* data, Record* aux, size_t n, std::vector<size_t>& counts, LastPass&& last_pass)
+{
+	using plan = _relational_plan<K>;
+
+	size_t active[plan::passes];
+	size_t active_count = 0;
+	for (size_t pass = 0; pass < plan::passes; ++pass)
+		if (counts[pass * plan::buckets + _relational_digit(data[0].key, pass)] != n)
+			active[active_count++] = pass;
+
+	if (active_count == 0)
+		return last_pass(data, plan::passes, (size_t*)nullptr);
+
+	Record* src = data;
+	Record* dst = aux;
+	for (size_t a = 0; a < active_count; ++a)
+	{
+		const size_t pass = active[a];
+		size_t* const offsets = counts.data() + pass * plan::buckets;
+		std::exclusive_scan(offsets, offsets + plan::buckets, offsets, size_t(0));
+
+		if (a + 1 == active_count)
+			return last_pass(src, pass, offsets);
+
+		for (size_t i = 0; i < n; ++i)
+			dst[offsets[_relational_digit(src[i].key, pass)]++] = std::move(src[i]);
+		std::swap(src, dst);
+	}
+}
+
+//Group-by core. Values are aggregated into the first record of their key while the last digit is scattered
+//into out_keys/out_values, then the per-bucket groups are packed together
+template<std::integral K, class V, class ValueAt, class Aggregate>
+size_t _group_by_impl(std::span<const K> keys, ValueAt&& value_at, Aggregate&& aggregate,
+	std::vector<K>& out_keys, std::vector<V>* out_values)
+{
+	using plan = _relational_plan<K>;
+	using record = _relational_record<K, V>;
+	static constexpr bool has_values = !std::is_same_v<V, _relational_no_value>;
+
+	const size_t n = keys.size();
+	out_keys.clear();
+	if constexpr (has_values)
+		out_values->clear();
+	if (n == 0)
+		return 0;
+
+	const auto buffer = std::make_unique_for_overwrite<record[]>(2 * n);
+	std::vector<size_t> counts;
+	_relational_gather<K, V>(keys, value_at, buffer.get(), counts);
+
+	out_keys.resize(n);
+	if constexpr (has_values)
+		out_values->resize(n);
+
+	size_t groups = 0;
+	_relational_radix_passes<K>(buffer.get(), buffer.get() + n, n, counts, [&]
+	(record* src, size_t pass, size_t* begins)
+	{
+		if (pass == plan::passes)
+		{
+			out_keys[0] = src[0].key;
+			if constexpr (has_values)
+			{
+				(*out_values)[0] = std::move(src[0].value);
+				for (size_t i = 1; i < n; ++i)
+					aggregate((*out_values)[0], std::move(src[i].value));
+			}
+			groups = 1;
+			return;
+		}
+
+		size_t ends[plan::buckets];
+		std::copy(begins, begins + plan::buckets, ends);
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			const size_t bucket = _relational_digit(src[i].key, pass);
+			size_t& end = ends[bucket];
+			if (end != begins[bucket] && out_keys[end - 1] == src[i].key)
+			{
+				if constexpr (has_values)
+					aggregate((*out_values)[end - 1], std::move(src[i].value));
+				continue;
+			}
+			out_keys[end] = src[i].key;
+			if constexpr (has_values)
+				(*out_values)[end] = std::move(src[i].value);
+			++end;
+		}
+
+		for (size_t b = 0; b < plan::buckets; ++b)
+		{
+			for (size_t i = begins[b]; i < ends[b]; ++i, ++groups)
+			{
+				out_keys[groups] = out_keys[i];
+				if constexpr (has_values)
+					(*out_values)[groups] = std::move((*out_values)[i]);
+			}
+		}
+	});
+
+	out_keys.resize(groups);
+	if constexpr (has_values)
+		out_values->resize(groups);
+	return groups;
+}
+
+_KSN_DETAIL_END
+
+//Groups rows by key and folds each group's values with aggregate(V& accumulator, V&& value),
+//starting from the group's first value. Output is ordered by key. Returns the number of groups.
+//Throws if keys and values are not the same number of rows
+template<std::integral K, class V, class Aggregate>
+size_t group_by(std::span<const K> keys, std::span<const V> values, Aggregate&& aggregate,
+	std::vector<K>& out_keys, std::vector<V>& out_values)
+{
+	if (keys.size() != values.size())
+		throw std::runtime_error("group_by: keys and values differ in size");
+	return detail::_group_by_impl<K, V>(keys, [&](size_t i) { return values[i]; }, aggregate, out_keys, &out_values);
+}
+
+//Distinct keys in ascending order with the number of occurrences of each
+template<std::integral K>
+size_t unique_counts(std::span<const K> keys, std::vector<K>& out_keys, std::vector<size_t>& out_counts)
+{
+	return detail::_group_by_impl<K, size_t>(keys, [](size_t) { return size_t(1); },
+		[](size_t& acc, size_t x) { acc += x; }, out_keys, &out_counts);
+}
+
+//Distinct keys in ascending order
+template<std::integral K>
+size_t sort_unique(std::span<const K> keys, std::vector<K>& out_keys)
+{
+	return detail::_group_by_impl<K, detail::_relational_no_value>(keys, [](size_t) { return detail::_relational_no_value{}; },
+		[](auto&&...) {}, out_keys, nullptr);
+}
+
+//Calls match(left_row, right_row) for every pair of rows with equal keys, in key order.
+//Both sides are radix sorted as (key, row) records, so rows of equal keys come in ascending order
+template<std::integral K, class Match>
+void merge_join(std::span<const K> left, std::span<const K> right, Match&& match)
+{
+	using record = detail::_relational_record<K, size_t>;
+
+	auto sorted_rows = [](std::span<const K> keys)
+	{
+		const size_t n = keys.size();
+		auto buffer = std::make_unique_for_overwrite<record[]>(2 * n);
+		record* result = buffer.get();
+		if (n == 0)
+			return std::pair{ std::move(buffer), result };
+
+		std::vector<size_t> counts;
+		detail::_relational_gather<K, size_t>(keys, [](size_t i) { return i; }, buffer.get(), counts);
+		detail::_relational_radix_passes<K>(buffer.get(), buffer.get() + n, n, counts, [&]
+		(record* src, size_t pass, size_t* begins)
+		{
+			if (pass == detail::_relational_plan<K>::passes)
+			{
+				result = src;
+				return;
+			}
+			record* dst = src == buffer.get() ? buffer.get() + n : buffer.get();
+			for (size_t i = 0; i < n; ++i)
+				dst[begins[detail::_relational_digit(src[i].key, pass)]++] = src[i];
+			result = dst;
+		});
+		return std::pair{ std::move(buffer), result };
+	};
+
+	const auto [left_buffer, l] = sorted_rows(left);
+	const auto [right_buffer, r] = sorted_rows(right);
+
+	const auto less = [](K a, K b) { return detail::_radix_sort_key<sizeof(K) * CHAR_BIT>(a) < detail::_radix_sort_key<sizeof(K) * CHAR_BIT>(b); };
+
+	size_t i = 0, j = 0;
+	while (i < left.size() && j < right.size())
+	{
+		if (less(l[i].key, r[j].key))
+			++i;
+		else if (less(r[j].key, l[i].key))
+			++j;
+		else
+		{
+			size_t i_end = i, j_end = j;
+			while (i_end < left.size() && l[i_end].key == l[i].key)
+				++i_end;
+			while (j_end < right.size() && r[j_end].key == r[j].key)
+				++j_end;
+
+			for (size_t a = i; a < i_end; ++a)
+				for (size_t b = j; b < j_end; ++b)
+					match(l[a].value, r[b].value);
+
+			i = i_end;
+			j = j_end;
+		}
+	}
+}
+
+_KSN_END
+
+#endif //!_KSN_RELATIONAL_HPP_
@@ -0,0 +1,119 @@
+
+#include "relational.hpp"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <stdexcept>
+
+
+template<class Callable>
+double measure_ms(Callable&& f)
+{
+	const auto t1 = std::chrono::steady_clock::now();
+	f();
+	const auto t2 = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(t2 - t1).count();
+}
+
+//Baseline: sort (key, value) pairs, then aggregate in a separate pass
+void sort_then_aggregate(const std::vector<uint32_t>& keys, const std::vector<int64_t>& values,
+	std::vector<uint32_t>& out_keys, std::vector<int64_t>& out_values)
+{
+	std::vector<std::pair<uint32_t, int64_t>> rows(keys.size());
+	for (size_t i = 0; i < keys.size(); ++i)
+		rows[i] = { keys[i], values[i] };
+	std::stable_sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	out_keys.clear();
+	out_values.clear();
+	for (const auto& [key, value] : rows)
+	{
+		if (!out_keys.empty() && out_keys.back() == key)
+			out_values.back() += value;
+		else
+		{
+			out_keys.push_back(key);
+			out_values.push_back(value);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t max_n = argc > 1 ? std::stoull(argv[1]) : 10'000'000;
+	std::mt19937_64 rng;
+
+	for (size_t n = 1000; n <= max_n; n *= 10)
+	{
+		for (uint32_t distinct : { 100u, uint32_t(n / 10), UINT32_MAX })
+		{
+			std::vector<uint32_t> keys(n), other_keys(n / 4);
+			std::vector<int64_t> values(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				keys[i] = uint32_t(rng() % distinct);
+				values[i] = int64_t(rng() % 1000);
+			}
+			for (auto& key : other_keys)
+				key = keys[rng() % n];
+
+			std::vector<uint32_t> expected_keys, group_keys;
+			std::vector<int64_t> expected_sums, group_sums;
+			std::vector<size_t> counts;
+
+			const double baseline = measure_ms([&] { sort_then_aggregate(keys, values, expected_keys, expected_sums); });
+			const double grouped = measure_ms([&]
+			{
+				ksn::group_by<uint32_t, int64_t>(keys, values, [](int64_t& acc, int64_t x) { acc += x; }, group_keys, group_sums);
+			});
+			if (group_keys != expected_keys || group_sums != expected_sums)
+				std::cout << "Error: group_by on n = " << n << std::endl;
+
+			const double counted = measure_ms([&] { ksn::unique_counts<uint32_t>(keys, group_keys, counts); });
+			if (group_keys != expected_keys || std::accumulate(counts.begin(), counts.end(), size_t(0)) != n)
+				std::cout << "Error: unique_counts on n = " << n << std::endl;
+
+			std::cout << "n = " << std::setw(8) << n << ", " << std::setw(10) << expected_keys.size() << " groups: " <<
+				"sort+aggregate " << baseline << " ms, group_by " << grouped << " ms, unique_counts " << counted << " ms";
+
+			//The join output grows with the square of the group sizes
+			if (n <= uint64_t(distinct) * 100)
+			{
+				size_t matches = 0, expected_matches = 0;
+				const double joined = measure_ms([&]
+				{
+					ksn::merge_join<uint32_t>(keys, other_keys, [&](size_t l, size_t r) { matches += keys[l] == other_keys[r]; });
+				});
+				for (uint32_t key : other_keys)
+				{
+					const auto it = std::lower_bound(expected_keys.begin(), expected_keys.end(), key);
+					expected_matches += counts[it - expected_keys.begin()];
+				}
+				if (matches != expected_matches)
+					std::cout << "\nError: merge_join on n = " << n << std::endl;
+
+				std::cout << ", merge_join (" << matches << " matches) " << joined << " ms";
+			}
+			std::cout << '\n';
+		}
+	}
+
+	try
+	{
+		std::vector<uint32_t> keys(10), group_keys;
+		std::vector<int64_t> values(9), group_sums;
+		ksn::group_by<uint32_t, int64_t>(keys, values, [](int64_t& acc, int64_t x) { acc += x; }, group_keys, group_sums);
+		std::cout << "Error: group_by accepted keys and values of different sizes\n";
+	}
+	catch (const std::runtime_error&)
+	{
+	}
+
+	return 0;
+}
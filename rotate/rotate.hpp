@@ -6,8 +6,12 @@
 #include <concepts>
 #include <span>
 #include <algorithm>
+#include <numeric>
+#include <memory>
+#include <type_traits>
 
 #include <cstddef>
+#include <cstring>
 
 
 template<class T>
@@ -18,19 +22,172 @@ T replace_if_equal(T x, const T& to, T with)
 	return x;
 }
 
+
+
+//Stack buffer used by the memmove-based rotates, in bytes
+static constexpr size_t _xrotate_buffer_size = 4096;
+
+//Elements at least this big are rotated with the cycle-leader algorithm if both sides are long
+//(every element is moved exactly once, and the jumps between cache lines are paid anyway)
+static constexpr size_t _xrotate_cycle_min_element_size = 32;
+
+template<class Iter>
+concept _xrotate_trivial_iterator =
+	std::contiguous_iterator<Iter> &&
+	std::is_trivially_copyable_v<std::iter_value_t<Iter>>;
+
+
+
+//Three-reversal rotate, works for any element type
+template<std::bidirectional_iterator Iter>
+void xrotate_reverse(Iter first, Iter new_first, Iter end)
+{
+	if (first == new_first || new_first == end)
+		return;
+
+	std::reverse(first, new_first);
+	std::reverse(new_first, end);
+	std::reverse(first, end);
+}
+
+//Gries-Mills block swap rotate, works for any element type
+template<std::random_access_iterator Iter>
+void xrotate_swap(Iter first, Iter new_first, Iter end)
+{
+	size_t n = end - first;
+	size_t k = replace_if_equal<size_t>(new_first - first, n, 0);
+
+	while (n > 1 && k != 0)
+	{
+		for (size_t i = 0; i < n - k; ++i)
+			iter_swap(first + i, first + i + k);
+
+		first += n - k;
+		const size_t r = n % k;
+		n = k;
+		k = k - r;
+		if (k == n)
+			break;
+	}
+}
+
+//GCD cycle-leader rotate, every element is moved exactly once
+template<_xrotate_trivial_iterator Iter>
+void xrotate_cycle(Iter first, Iter new_first, Iter end)
+{
+	using T = std::iter_value_t<Iter>;
+
+	const size_t n = end - first;
+	const size_t k = new_first - first;
+	if (n <= 1 || k == 0 || k == n)
+		return;
+
+	T* const arr = std::to_address(first);
+	const size_t cycles = std::gcd(n, k);
+
+	for (size_t start = 0; start < cycles; ++start)
+	{
+		const T tmp = arr[start];
+		size_t i = start;
+		while (true)
+		{
+			size_t next = i + k;
+			if (next >= n)
+				next -= n;
+			if (next == start)
+				break;
+			arr[i] = arr[next];
+			i = next;
+		}
+		arr[i] = tmp;
+	}
+}
+
+//Gries-Mills block swap rotate, blocks are exchanged through a stack buffer with memcpy.
+//If the smaller side fits into the buffer, the rotate is done with a single memmove instead
+template<_xrotate_trivial_iterator Iter>
+void xrotate_buffered(Iter first, Iter new_first, Iter end)
+{
+	using T = std::iter_value_t<Iter>;
+	static constexpr size_t buffer_elements = std::max<size_t>(_xrotate_buffer_size / sizeof(T), 1);
+
+	alignas(T) unsigned char buffer_storage[buffer_elements * sizeof(T)];
+	T* const buffer = (T*)buffer_storage;
+
+	T* arr = std::to_address(first);
+	size_t left = new_first - first;
+	size_t right = end - new_first;
+
+	auto swap_blocks = [&]
+	(T* a, T* b, size_t count)
+	{
+		while (count)
+		{
+			const size_t chunk = std::min(count, buffer_elements);
+			memcpy(buffer, a, chunk * sizeof(T));
+			memcpy(a, b, chunk * sizeof(T));
+			memcpy(b, buffer, chunk * sizeof(T));
+			a += chunk;
+			b += chunk;
+			count -= chunk;
+		}
+	};
+
+	while (left != 0 && right != 0)
+	{
+		if (left <= buffer_elements && left <= right)
+		{
+			memcpy(buffer, arr, left * sizeof(T));
+			memmove(arr, arr + left, right * sizeof(T));
+			memcpy(arr + right, buffer, left * sizeof(T));
+			return;
+		}
+		if (right <= buffer_elements)
+		{
+			memcpy(buffer, arr + left, right * sizeof(T));
+			memmove(arr + right, arr, left * sizeof(T));
+			memcpy(arr, buffer, right * sizeof(T));
+			return;
+		}
+
+		if (left <= right)
+		{
+			//[A B1 B2] -> [B2 B1 A], |A| = |B2|, continue with [B2 B1]
+			swap_blocks(arr, arr + right, left);
+			right -= left;
+		}
+		else
+		{
+			//[A1 A2 B] -> [B A2 A1], |A1| = |B|, continue with [A2 A1]
+			swap_blocks(arr, arr + left, right);
+			arr += right;
+			left -= right;
+		}
+	}
+}
+
 template<std::random_access_iterator Iter>
 void xrotate(Iter first, Iter new_first, Iter end)
 {
+	using T = std::iter_value_t<Iter>;
+
 	const size_t n = end - first;
-	const size_t k = replace_if_equal<size_t>(new_first - first, n, 0);
-	std::span _debug(first, n);
+	const size_t k = new_first - first;
 
-	if (n <= 1 || k == 0)
+	if (n <= 1 || k == 0 || k == n)
 		return;
 
-	for (size_t i = 0; i < n - k; ++i)
-		iter_swap(first + i, first + i + k);
-	return xrotate(first + n - k, first + n - n % k, end);
+	if constexpr (_xrotate_trivial_iterator<Iter>)
+	{
+		const size_t smaller_side = std::min(k, n - k);
+		if (smaller_side * sizeof(T) <= _xrotate_buffer_size)
+			return xrotate_buffered(first, new_first, end);
+		if (sizeof(T) >= _xrotate_cycle_min_element_size && smaller_side >= n / 4)
+			return xrotate_cycle(first, new_first, end);
+		return xrotate_buffered(first, new_first, end);
+	}
+	else
+		return xrotate_reverse(first, new_first, end);
 }
 
 #endif //!_ROTATE_HPP_
@@ -1,11 +1,89 @@
 
 #include <vector>
+#include <array>
+#include <chrono>
+#include <random>
+#include <numeric>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
 
 #include "rotate.hpp"
 
-int main1()
+
+struct noop { constexpr void operator()(){} };
+
+template<class Callable, class Callable2 = noop>
+uint64_t measure(Callable&& f, size_t times = 1, Callable2&& prep = {})
+{
+	using namespace std;
+	using namespace chrono;
+	auto clock_f = &steady_clock::now;
+	uint64_t dt = UINT64_MAX;
+	for (size_t i = 0; i < times; ++i)
+	{
+		prep();
+		auto t1 = clock_f();
+		f();
+		auto t2 = clock_f();
+		dt = std::min<uint64_t>(dt, duration_cast<nanoseconds>(t2 - t1).count());
+	}
+	return dt;
+}
+
+template<class T>
+void bench_type(const char* type_name, size_t n)
 {
-	std::vector v{ 0,1,2,3,4,5,6,7,8,9 };
-	xrotate(v.begin(), v.begin() + 5, v.end());
+	std::vector<T> v0(n), v(n), expected(n);
+	for (size_t i = 0; i < n; ++i)
+		std::memset(&v0[i], int(i * 7), sizeof(T));
+
+	const size_t ks[] = { 1, 7, 64, n / 3, n / 2, n - 100, n - 1 };
+
+	std::cout << type_name << ", n = " << n << '\n';
+	std::cout << std::setw(10) << "k" <<
+		std::setw(12) << "std" <<
+		std::setw(12) << "xrotate" <<
+		std::setw(12) << "swap" <<
+		std::setw(12) << "reverse" <<
+		std::setw(12) << "cycle" <<
+		std::setw(12) << "buffered" << " (us)\n";
+
+	for (size_t k : ks)
+	{
+		expected = v0;
+		std::rotate(expected.begin(), expected.begin() + k, expected.end());
+
+		auto refill = [&] { v = v0; };
+		auto run = [&]
+		(auto&& rotate_f)
+		{
+			constexpr size_t measures = 5;
+			auto dt = measure([&] { rotate_f(v.begin(), v.begin() + k, v.end()); }, measures, refill) / 1000;
+			if (std::memcmp(v.data(), expected.data(), n * sizeof(T)) != 0)
+				std::cout << "Error on k = " << k << std::endl;
+			return dt;
+		};
+
+		using Iter = typename std::vector<T>::iterator;
+		std::cout << std::setw(10) << k <<
+			std::setw(12) << run([](Iter a, Iter b, Iter c) { std::rotate(a, b, c); }) <<
+			std::setw(12) << run(xrotate<Iter>) <<
+			std::setw(12) << run(xrotate_swap<Iter>) <<
+			std::setw(12) << run(xrotate_reverse<Iter>) <<
+			std::setw(12) << run(xrotate_cycle<Iter>) <<
+			std::setw(12) << run(xrotate_buffered<Iter>) << '\n';
+	}
+}
+
+int main()
+{
+	constexpr size_t N = 10'000'000;
+
+	bench_type<uint8_t>("uint8_t", N);
+	bench_type<uint32_t>("uint32_t", N);
+	bench_type<uint64_t>("uint64_t", N);
+	bench_type<std::array<uint64_t, 8>>("64 byte struct", N / 8);
+
 	return 0;
 }
@@ -0,0 +1,98 @@
+
+#ifndef _QUICKSELECT_HPP_
+#define _QUICKSELECT_HPP_
+
+#include <iterator>
+#include <functional>
+#include <concepts>
+#include <random>
+#include <utility>
+#include <algorithm>
+
+
+template<
+	std::forward_iterator It,
+	class T = std::iterator_traits<It>::value_type,
+	std::strict_weak_order<T, T> Pred = std::less<T>>
+It rearrange(It begin, It end, It value, Pred pred = {})
+{
+	It result = end;
+	while (begin != end)
+	{
+		if (!pred(*value, *begin))
+			++begin;
+		else
+		{
+			while (true)
+			{
+				--end;
+				if (begin == end)
+					break;
+				else if (!pred(*value, *end))
+				{
+					std::iter_swap(begin, end);
+					if (value == begin)
+						value = end;
+					else if (value == end)
+						value = begin;
+					--result;
+					++begin;
+					break;
+				}
+			}
+		}
+	}
+	return begin;
+}
+
+template<std::random_access_iterator It, class T = std::iterator_traits<It>::value_type, std::strict_weak_order<T, T> Pred = std::less<void>>
+void quickselect(It begin, It nth, It end, Pred pred = {})
+{
+	static std::minstd_rand rng;
+
+	while (true)
+	{
+		const size_t N = end - begin;
+		if (N <= 1)
+			return;
+
+		It p1 = begin + rng() % N;
+		It p2 = begin + rng() % N;
+		It p3 = begin + rng() % N;
+
+		if (pred(*p2, *p1)) std::swap(p1, p2);
+		if (pred(*p3, *p2)) std::swap(p3, p2);
+		if (pred(*p2, *p1)) std::swap(p1, p2);
+
+		It div = rearrange(begin, end, p2, pred);
+		if (div == end)
+		{
+			//Nothing is greater than the pivot, split off the elements equivalent to it instead
+			const T pivot = *p2;
+			div = std::partition(begin, end, [&](const T& x) { return pred(x, pivot); });
+			if (div <= nth)
+				return;
+			end = div;
+			continue;
+		}
+		if (div <= nth)
+			begin = div;
+		else
+			end = div;
+	}
+}
+//it's not quick bruh
+template<std::random_access_iterator It, class T = std::iterator_traits<It>::value_type, std::strict_weak_order<T, T> Pred = std::less<void>>
+void quickselect_sort(It begin, It end, Pred pred = {})
+{
+	const size_t n = end - begin;
+	if (n <= 1)
+		return;
+
+	auto nth = begin + n / 2;
+	quickselect(begin, nth, end, pred);
+	quickselect_sort(begin, nth, pred);
+	quickselect_sort(nth, end, pred);
+}
+
+#endif //!_QUICKSELECT_HPP_
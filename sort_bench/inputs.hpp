@@ -0,0 +1,156 @@
+
+#ifndef _SORT_BENCH_INPUTS_HPP_
+#define _SORT_BENCH_INPUTS_HPP_
+
+#include <vector>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <concepts>
+#include <cmath>
+
+#include <stdint.h>
+
+
+//Input generators shared by the sort benchmarks and tests
+
+enum class input_distribution
+{
+	uniform,
+	skewed,
+	sorted,
+	reversed,
+	few_unique,
+	organ_pipe,
+};
+
+inline constexpr input_distribution all_input_distributions[] =
+{
+	input_distribution::uniform,
+	input_distribution::skewed,
+	input_distribution::sorted,
+	input_distribution::reversed,
+	input_distribution::few_unique,
+	input_distribution::organ_pipe,
+};
+
+inline const char* input_distribution_name(input_distribution dist)
+{
+	switch (dist)
+	{
+	case input_distribution::uniform: return "uniform";
+	case input_distribution::skewed: return "skewed";
+	case input_distribution::sorted: return "sorted";
+	case input_distribution::reversed: return "reversed";
+	case input_distribution::few_unique: return "few_unique";
+	case input_distribution::organ_pipe: return "organ_pipe";
+	}
+	return "?";
+}
+
+//Values spread as max^u for uniform u, so small values are much more frequent
+template<class T, class RNG>
+T mydist(RNG&& engine)
+{
+	std::uniform_int_distribution<uint32_t> dist(0, UINT32_MAX);
+	uint32_t val = dist(engine);
+	return (T)std::pow((double)std::numeric_limits<T>::max(), double(val) / UINT32_MAX);
+}
+
+template<class T>
+struct input_value_generator
+{
+	template<class RNG>
+	T uniform(RNG& rng) const
+	{
+		std::uniform_int_distribution<T> dist(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+		return dist(rng);
+	}
+
+	template<class RNG>
+	T skewed(RNG& rng) const
+	{
+		return mydist<T>(rng);
+	}
+};
+
+template<>
+struct input_value_generator<std::string>
+{
+	template<class RNG>
+	std::string uniform(RNG& rng) const
+	{
+		std::uniform_int_distribution<int> length(1, 24);
+		std::uniform_int_distribution<int> letter('a', 'z');
+		std::string result(length(rng), '\0');
+		for (auto& c : result)
+			c = (char)letter(rng);
+		return result;
+	}
+
+	//Decimal numbers with a skewed magnitude, many strings share long prefixes
+	template<class RNG>
+	std::string skewed(RNG& rng) const
+	{
+		return std::to_string(mydist<uint64_t>(rng));
+	}
+};
+
+template<class T, class Alloc>
+void generate_input(std::vector<T, Alloc>& v, size_t n, input_distribution dist, uint64_t seed)
+{
+	std::mt19937_64 rng(seed);
+	input_value_generator<T> gen;
+
+	v.clear();
+	v.reserve(n);
+
+	switch (dist)
+	{
+	case input_distribution::skewed:
+		for (size_t i = 0; i < n; ++i)
+			v.push_back(gen.skewed(rng));
+		break;
+
+	case input_distribution::few_unique:
+	{
+		static constexpr size_t unique_values = 16;
+		T values[unique_values];
+		for (auto& x : values)
+			x = gen.uniform(rng);
+		for (size_t i = 0; i < n; ++i)
+			v.push_back(values[rng() % unique_values]);
+		break;
+	}
+
+	default:
+		for (size_t i = 0; i < n; ++i)
+			v.push_back(gen.uniform(rng));
+		break;
+	}
+
+	switch (dist)
+	{
+	case input_distribution::sorted:
+		std::sort(v.begin(), v.end());
+		break;
+
+	case input_distribution::reversed:
+		std::sort(v.begin(), v.end(), std::greater<>{});
+		break;
+
+	case input_distribution::organ_pipe:
+		std::sort(v.begin(), v.begin() + n / 2);
+		std::sort(v.begin() + n / 2, v.end(), std::greater<>{});
+		break;
+
+	default:
+		break;
+	}
+}
+
+#endif //!_SORT_BENCH_INPUTS_HPP_
@@ -0,0 +1,294 @@
+
+#include "inputs.hpp"
+#include "sorts.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <memory_resource>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <Windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+
+struct bench_options
+{
+	size_t min_size = 10;
+	size_t max_size = 10'000'000;
+	size_t runs = 9;
+	size_t warmup = 2;
+	int cpu = -1;
+	uint64_t seed = 1;
+	bool json = false;
+	std::string output;
+
+	//Comma-separated filters, empty means everything
+	std::string sorts;
+	std::string types;
+	std::string distributions;
+};
+
+struct bench_result
+{
+	const char* sort;
+	const char* type;
+	const char* distribution;
+	size_t n;
+	size_t runs;
+	double median_ns;
+	double p10_ns;
+	double p90_ns;
+	double min_ns;
+	double elements_per_s;
+	double bytes_per_s;
+	bool ok;
+};
+
+bool filter_accepts(std::string_view filter, std::string_view name)
+{
+	if (filter.empty())
+		return true;
+	while (!filter.empty())
+	{
+		const size_t comma = std::min(filter.find(','), filter.size());
+		if (filter.substr(0, comma) == name)
+			return true;
+		filter.remove_prefix(std::min(comma + 1, filter.size()));
+	}
+	return false;
+}
+
+bool pin_to_cpu(int cpu)
+{
+#if defined(_WIN32)
+	return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+//Nearest-rank percentile of sorted samples
+double percentile(const std::vector<double>& sorted_samples, double p)
+{
+	const size_t idx = std::min(sorted_samples.size() - 1, size_t(p * sorted_samples.size()));
+	return sorted_samples[idx];
+}
+
+
+
+class bench_output
+{
+	std::ofstream file;
+	std::ostream* out;
+	bool json;
+	bool first = true;
+
+public:
+	bench_output(const bench_options& opt)
+		: out(&std::cout), json(opt.json)
+	{
+		if (!opt.output.empty())
+		{
+			file.open(opt.output);
+			out = &file;
+		}
+
+		if (json)
+			*out << "[\n";
+		else
+			*out << "sort,type,distribution,n,runs,median_ns,p10_ns,p90_ns,min_ns,elements_per_s,bytes_per_s,ok\n";
+	}
+
+	~bench_output()
+	{
+		if (json)
+			*out << "\n]\n";
+	}
+
+	void write(const bench_result& r)
+	{
+		if (json)
+		{
+			if (!first)
+				*out << ",\n";
+			*out << "  { \"sort\": \"" << r.sort <<
+				"\", \"type\": \"" << r.type <<
+				"\", \"distribution\": \"" << r.distribution <<
+				"\", \"n\": " << r.n <<
+				", \"runs\": " << r.runs <<
+				", \"median_ns\": " << r.median_ns <<
+				", \"p10_ns\": " << r.p10_ns <<
+				", \"p90_ns\": " << r.p90_ns <<
+				", \"min_ns\": " << r.min_ns <<
+				", \"elements_per_s\": " << r.elements_per_s <<
+				", \"bytes_per_s\": " << r.bytes_per_s <<
+				", \"ok\": " << (r.ok ? "true" : "false") << " }";
+		}
+		else
+		{
+			*out << r.sort << ',' << r.type << ',' << r.distribution << ',' <<
+				r.n << ',' << r.runs << ',' <<
+				r.median_ns << ',' << r.p10_ns << ',' << r.p90_ns << ',' << r.min_ns << ',' <<
+				r.elements_per_s << ',' << r.bytes_per_s << ',' << (r.ok ? 1 : 0) << '\n';
+		}
+		out->flush();
+		first = false;
+	}
+};
+
+
+
+template<class T>
+void bench_type(const char* type_name, const bench_options& opt, bench_output& out)
+{
+	if (!filter_accepts(opt.types, type_name))
+		return;
+
+	//Small inputs are sorted in batches of copies so that a sample lasts long enough for the clock
+	static constexpr size_t min_batch_elements = 1 << 16;
+
+	std::pmr::vector<T> input;
+
+	for (input_distribution dist : all_input_distributions)
+	{
+		const char* dist_name = input_distribution_name(dist);
+		if (!filter_accepts(opt.distributions, dist_name))
+			continue;
+
+		for (size_t n = opt.min_size; n <= opt.max_size; n *= 10)
+		{
+			generate_input(input, n, dist, opt.seed + n);
+
+			const size_t copies = std::max<size_t>(1, min_batch_elements / n);
+			std::vector<std::pmr::vector<T>> work(copies);
+
+			for_each_sort<T>([&]
+			(sort_traits traits, sort_function_t<T> sort)
+			{
+				if (!filter_accepts(opt.sorts, traits.name))
+					return;
+
+				std::vector<double> samples;
+				bool ok = true;
+
+#if KSN_SORT_PERF
+				ksn::sort_perf::reset();
+#endif
+
+				for (size_t run = 0; run < opt.warmup + opt.runs; ++run)
+				{
+					for (auto& v : work)
+						v.assign(input.begin(), input.end());
+
+					const auto t1 = std::chrono::steady_clock::now();
+					for (auto& v : work)
+						sort(v);
+					const auto t2 = std::chrono::steady_clock::now();
+
+					ok = ok && std::is_sorted(work[0].begin(), work[0].end());
+					if (run >= opt.warmup)
+						samples.push_back(std::chrono::duration<double, std::nano>(t2 - t1).count() / copies);
+				}
+
+#if KSN_SORT_PERF
+				const std::string title = std::string(traits.name) + ", " + type_name + ", " + dist_name + ", n = " + std::to_string(n);
+				ksn::sort_perf::report(std::cerr, title.c_str());
+#endif
+
+				std::sort(samples.begin(), samples.end());
+				const double median = percentile(samples, 0.5);
+
+				out.write(bench_result{
+					.sort = traits.name,
+					.type = type_name,
+					.distribution = dist_name,
+					.n = n,
+					.runs = opt.runs,
+					.median_ns = median,
+					.p10_ns = percentile(samples, 0.1),
+					.p90_ns = percentile(samples, 0.9),
+					.min_ns = samples.front(),
+					.elements_per_s = n / median * 1e9,
+					.bytes_per_s = n * sizeof(T) / median * 1e9,
+					.ok = ok,
+				});
+			});
+		}
+	}
+}
+
+void print_usage()
+{
+	std::cerr <<
+		"Usage: sort_bench [options]\n"
+		"  --min-size=N         smallest input size, multiplied by 10 up to max-size (10)\n"
+		"  --max-size=N         largest input size (10000000)\n"
+		"  --runs=N             timed runs per case (9)\n"
+		"  --warmup=N           untimed runs per case (2)\n"
+		"  --cpu=N              pin the benchmark to a CPU\n"
+		"  --seed=N             input seed (1)\n"
+		"  --format=csv|json    output format (csv)\n"
+		"  --output=PATH        write results to a file instead of stdout\n"
+		"  --sort=a,b,...       only run these sorts\n"
+		"  --type=a,b,...       only these element types: uint32, uint64, int32, string\n"
+		"  --dist=a,b,...       only these distributions: uniform, skewed, sorted, reversed, few_unique, organ_pipe\n";
+}
+
+int main(int argc, char** argv)
+{
+	bench_options opt;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		const size_t eq = arg.find('=');
+		const std::string_view key = arg.substr(0, eq);
+		const std::string value(eq == arg.npos ? "" : arg.substr(eq + 1));
+
+		if (key == "--min-size") opt.min_size = (size_t)std::stod(value);
+		else if (key == "--max-size") opt.max_size = (size_t)std::stod(value);
+		else if (key == "--runs") opt.runs = std::stoull(value);
+		else if (key == "--warmup") opt.warmup = std::stoull(value);
+		else if (key == "--cpu") opt.cpu = std::stoi(value);
+		else if (key == "--seed") opt.seed = std::stoull(value);
+		else if (key == "--format") opt.json = value == "json";
+		else if (key == "--output") opt.output = value;
+		else if (key == "--sort") opt.sorts = value;
+		else if (key == "--type") opt.types = value;
+		else if (key == "--dist") opt.distributions = value;
+		else
+		{
+			print_usage();
+			return 1;
+		}
+	}
+
+	if (opt.runs == 0 || opt.min_size == 0)
+	{
+		print_usage();
+		return 1;
+	}
+	if (opt.cpu >= 0 && !pin_to_cpu(opt.cpu))
+		std::cerr << "Failed to pin to CPU " << opt.cpu << "\n";
+
+	bench_output out(opt);
+	bench_type<uint32_t>("uint32", opt, out);
+	bench_type<uint64_t>("uint64", opt, out);
+	bench_type<int32_t>("int32", opt, out);
+	bench_type<std::string>("string", opt, out);
+
+	return 0;
+}
@@ -0,0 +1,69 @@
+
+#ifndef _SORT_BENCH_SORTS_HPP_
+#define _SORT_BENCH_SORTS_HPP_
+
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+#include <concepts>
+#include <string>
+
+#include <limits.h>
+
+#include "../american_flag_sort/afsort.hpp"
+#include "../american_flag_sort/afsort_indirect.hpp"
+#include "../radix_sort/radix_sort.hpp"
+#include "../radix_sort/radix_sort_in_place.hpp"
+#include "../heap/heap.hpp"
+#include "../select/quick_sort.hpp"
+#include "../select/quickselect.hpp"
+#include "../stable_sort/stable_sort.hpp"
+#include "../async_sort/async_sort.hpp"
+
+
+//Every sort of the library under a common signature
+
+template<class T>
+using sort_function_t = void(*)(std::pmr::vector<T>&);
+
+struct sort_traits
+{
+	const char* name;
+	bool stable;
+};
+
+//Calls callback(sort_traits, sort_function_t<T>) for every sort applicable to T
+template<class T, class Callback>
+void for_each_sort(Callback&& callback)
+{
+	using vec = std::pmr::vector<T>;
+
+	callback(sort_traits{ "std::sort", false }, +[](vec& v) { std::sort(v.begin(), v.end()); });
+	callback(sort_traits{ "std::stable_sort", true }, +[](vec& v) { std::stable_sort(v.begin(), v.end()); });
+	callback(sort_traits{ "heap_sort", false }, +[](vec& v) { heap_sort(v); });
+	callback(sort_traits{ "quick_sort", false }, +[](vec& v) { quick_sort(v.begin(), v.end()); });
+	callback(sort_traits{ "quickselect_sort", false }, +[](vec& v) { quickselect_sort(v.begin(), v.end()); });
+	callback(sort_traits{ "xstable_sort", true }, +[](vec& v) { xstable_sort(v.begin(), v.end()); });
+	callback(sort_traits{ "symmerge_sort", true }, +[](vec& v) { symmerge_sort(v.begin(), v.end()); });
+
+	if constexpr (std::unsigned_integral<T>)
+	{
+		callback(sort_traits{ "afsort", false }, +[](vec& v) { ksn::afsort(v.begin(), v.end()); });
+		callback(sort_traits{ "radix_sort", true }, +[](vec& v) { ksn::radix_sort(v.begin(), v.end()); });
+		callback(sort_traits{ "async_afsort", false }, +[](vec& v) { ksn::async_afsort(std::span(v)).run(); });
+	}
+
+	if constexpr (std::unsigned_integral<T> || std::same_as<T, std::string>)
+		callback(sort_traits{ "afsort_indirect", false }, +[](vec& v) { ksn::afsort_indirect(v.begin(), v.end()); });
+
+	if constexpr (std::integral<T>)
+	{
+		constexpr size_t bits = sizeof(T) * CHAR_BIT;
+		callback(sort_traits{ "radix_sort_fixed", true }, +[](vec& v) { ksn::radix_sort<bits, 8>(v.begin(), v.end()); });
+		callback(sort_traits{ "radix_sort_fixed_minmax", true }, +[](vec& v) { ksn::radix_sort<bits, 11, true>(v.begin(), v.end()); });
+		callback(sort_traits{ "radix_sort_in_place", false }, +[](vec& v) { ksn::radix_sort_in_place(v.begin(), v.end()); });
+		callback(sort_traits{ "async_radix_sort", true }, +[](vec& v) { ksn::async_radix_sort(std::span(v)).run(); });
+	}
+}
+
+#endif //!_SORT_BENCH_SORTS_HPP_
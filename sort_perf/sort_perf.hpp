@@ -0,0 +1,248 @@
+
+#ifndef _KSN_SORT_PERF_HPP_
+#define _KSN_SORT_PERF_HPP_
+
+//Per-phase hardware counters for the radix sorts.
+//Compiled out unless KSN_SORT_PERF is defined to nonzero before including the sorts.
+//Counters come from perf_event_open on Linux; elsewhere (or without permission) only time and bytes are recorded
+
+#ifndef KSN_SORT_PERF
+#define KSN_SORT_PERF 0
+#endif
+
+#if KSN_SORT_PERF
+
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <iomanip>
+
+#include <stdint.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include <ksn/ksn.hpp>
+
+
+_KSN_BEGIN
+
+namespace sort_perf
+{
+	enum class phase : uint8_t
+	{
+		histogram,
+		prefix_sum,
+		permute,
+		recursion,
+		copy,
+	};
+
+	static constexpr size_t phases = 5;
+	static constexpr size_t max_depth = 16;
+	static constexpr size_t hw_counters = 5;
+
+	inline const char* phase_name(phase p)
+	{
+		static constexpr const char* names[phases] = { "histogram", "prefix_sum", "permute", "recursion", "copy" };
+		return names[(size_t)p];
+	}
+
+	struct counters
+	{
+		//cycles, instructions, LLC misses, dTLB misses, branch misses
+		std::array<uint64_t, hw_counters> hw{};
+		uint64_t nanoseconds = 0;
+		uint64_t bytes = 0;
+		uint64_t calls = 0;
+	};
+
+	//One perf event group per thread, read with a single syscall
+	class counter_group
+	{
+#if defined(__linux__)
+		int leader = -1;
+		int fds[hw_counters] = { -1, -1, -1, -1, -1 };
+
+		static int open_event(uint32_t type, uint64_t config, int group)
+		{
+			perf_event_attr attr{};
+			attr.size = sizeof(attr);
+			attr.type = type;
+			attr.config = config;
+			attr.disabled = group == -1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_GROUP;
+			return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+		}
+
+		static constexpr uint64_t cache_event(uint64_t cache, uint64_t op, uint64_t result)
+		{
+			return cache | (op << 8) | (result << 16);
+		}
+
+	public:
+		counter_group()
+		{
+			leader = fds[0] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+			if (leader == -1)
+				return;
+			fds[1] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, leader);
+			fds[2] = open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), leader);
+			fds[3] = open_event(PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS), leader);
+			fds[4] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, leader);
+			ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+
+		~counter_group()
+		{
+			for (int fd : fds)
+				if (fd != -1)
+					close(fd);
+		}
+
+		bool available() const noexcept
+		{
+			return leader != -1;
+		}
+
+		//Events that failed to open read as 0
+		void read_values(std::array<uint64_t, hw_counters>& values) const
+		{
+			values = {};
+			if (leader == -1)
+				return;
+
+			uint64_t buffer[1 + hw_counters]{};
+			if (::read(leader, buffer, sizeof(buffer)) <= 0)
+				return;
+
+			size_t opened = 0;
+			for (size_t i = 0; i < hw_counters; ++i)
+				if (fds[i] != -1)
+					values[i] = buffer[1 + opened++];
+		}
+#else
+	public:
+		bool available() const noexcept
+		{
+			return false;
+		}
+
+		void read_values(std::array<uint64_t, hw_counters>& values) const
+		{
+			values = {};
+		}
+#endif
+	};
+
+	struct thread_stats
+	{
+		counters data[phases][max_depth];
+		size_t depth = 0;
+	};
+
+	inline thread_local thread_stats stats;
+
+	inline counter_group& thread_counters()
+	{
+		static thread_local counter_group group;
+		return group;
+	}
+
+	//Measures its lifetime as one call of the phase. A recursion scope also moves
+	//every nested scope one level deeper
+	class scope
+	{
+		phase p;
+		size_t depth;
+		uint64_t bytes;
+		std::array<uint64_t, hw_counters> start_hw;
+		std::chrono::steady_clock::time_point start_time;
+
+	public:
+		scope(phase p, uint64_t bytes = 0)
+			: scope(p, stats.depth, bytes)
+		{
+		}
+
+		scope(phase p, size_t depth, uint64_t bytes)
+			: p(p), depth(depth < max_depth ? depth : max_depth - 1), bytes(bytes)
+		{
+			if (p == phase::recursion)
+				++stats.depth;
+			thread_counters().read_values(start_hw);
+			start_time = std::chrono::steady_clock::now();
+		}
+
+		~scope()
+		{
+			const auto end_time = std::chrono::steady_clock::now();
+			std::array<uint64_t, hw_counters> end_hw;
+			thread_counters().read_values(end_hw);
+
+			counters& c = stats.data[(size_t)p][depth];
+			for (size_t i = 0; i < hw_counters; ++i)
+				c.hw[i] += end_hw[i] - start_hw[i];
+			c.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
+			c.bytes += bytes;
+			++c.calls;
+
+			if (p == phase::recursion)
+				--stats.depth;
+		}
+
+		scope(const scope&) = delete;
+		scope& operator=(const scope&) = delete;
+	};
+
+	inline void reset()
+	{
+		stats = {};
+	}
+
+	//Table of the current thread's counters, one row per phase and depth that was hit
+	inline void report(std::ostream& out, const char* title = "")
+	{
+		out << "sort_perf: " << title << (thread_counters().available() ? "" : " (hardware counters unavailable)") << '\n';
+		out << std::setw(12) << "phase" << std::setw(7) << "depth" << std::setw(12) << "calls" <<
+			std::setw(14) << "ns" << std::setw(14) << "bytes" << std::setw(14) << "cycles" <<
+			std::setw(14) << "instructions" << std::setw(14) << "llc_misses" << std::setw(14) << "dtlb_misses" <<
+			std::setw(14) << "branch_miss" << '\n';
+
+		for (size_t p = 0; p < phases; ++p)
+		{
+			for (size_t d = 0; d < max_depth; ++d)
+			{
+				const counters& c = stats.data[p][d];
+				if (c.calls == 0)
+					continue;
+				out << std::setw(12) << phase_name((phase)p) << std::setw(7) << d << std::setw(12) << c.calls <<
+					std::setw(14) << c.nanoseconds << std::setw(14) << c.bytes;
+				for (uint64_t x : c.hw)
+					out << std::setw(14) << x;
+				out << '\n';
+			}
+		}
+	}
+}
+
+_KSN_END
+
+#define _KSN_SORT_PERF_CONCAT_IMPL(a, b) a##b
+#define _KSN_SORT_PERF_CONCAT(a, b) _KSN_SORT_PERF_CONCAT_IMPL(a, b)
+#define _KSN_SORT_PERF_SCOPE(...) ::ksn::sort_perf::scope _KSN_SORT_PERF_CONCAT(_ksn_sort_perf_scope_, __LINE__)(__VA_ARGS__)
+
+#else //KSN_SORT_PERF
+
+#define _KSN_SORT_PERF_SCOPE(...) ((void)0)
+
+#endif //KSN_SORT_PERF
+
+#endif //!_KSN_SORT_PERF_HPP_
@@ -0,0 +1,152 @@
+
+#ifndef _SORT_TEST_DIFFERENTIAL_HPP_
+#define _SORT_TEST_DIFFERENTIAL_HPP_
+
+#include <vector>
+#include <memory_resource>
+#include <algorithm>
+#include <concepts>
+#include <optional>
+#include <string>
+
+#include <stdint.h>
+
+#include "../sort_bench/sorts.hpp"
+#include "../heap/heap.hpp"
+#include "../select/quickselect.hpp"
+
+
+//Differential checks of the library's sorts and selects against the standard library.
+//Every check returns an error description, or nothing if the routine behaved
+
+//Element ordered by key only, index tells equivalent elements apart to check stability
+struct keyed_record
+{
+	uint32_t key;
+	uint32_t index;
+
+	bool operator<(const keyed_record& other) const { return key < other.key; }
+	bool operator>(const keyed_record& other) const { return key > other.key; }
+	bool operator==(const keyed_record& other) const = default;
+};
+
+template<class T>
+concept has_identity_beyond_order = requires(const T& x) { x.index; };
+
+template<class T>
+bool equivalent(const T& a, const T& b)
+{
+	return !(a < b) && !(b < a);
+}
+
+template<class T>
+std::optional<std::string> check_sort(sort_traits traits, sort_function_t<T> sort, const std::pmr::vector<T>& input)
+{
+	std::pmr::vector<T> expected(input.begin(), input.end());
+	std::stable_sort(expected.begin(), expected.end());
+
+	std::pmr::vector<T> actual(input.begin(), input.end());
+	sort(actual);
+
+	if (actual.size() != expected.size())
+		return "size changed";
+
+	if (traits.stable || !has_identity_beyond_order<T>)
+	{
+		if (actual != expected)
+			return traits.stable ? "differs from std::stable_sort" : "differs from std::sort";
+		return std::nullopt;
+	}
+
+	if (!std::equal(actual.begin(), actual.end(), expected.begin(), equivalent<T>))
+		return "not sorted like std::sort";
+	if (!std::is_permutation(actual.begin(), actual.end(), input.begin()))
+		return "not a permutation of the input";
+	return std::nullopt;
+}
+
+template<class T>
+std::optional<std::string> check_quickselect(const std::pmr::vector<T>& input, size_t nth)
+{
+	if (nth >= input.size())
+		return std::nullopt;
+
+	std::pmr::vector<T> expected(input.begin(), input.end());
+	std::nth_element(expected.begin(), expected.begin() + nth, expected.end());
+
+	std::pmr::vector<T> actual(input.begin(), input.end());
+	quickselect(actual.begin(), actual.begin() + nth, actual.end());
+
+	if (!equivalent(actual[nth], expected[nth]))
+		return "nth element differs from std::nth_element";
+	for (size_t i = 0; i < nth; ++i)
+		if (actual[nth] < actual[i])
+			return "greater element before nth";
+	for (size_t i = nth + 1; i < actual.size(); ++i)
+		if (actual[i] < actual[nth])
+			return "smaller element after nth";
+	if (!std::is_permutation(actual.begin(), actual.end(), input.begin()))
+		return "not a permutation of the input";
+	return std::nullopt;
+}
+
+//push_heap/erase_min_heap must pop the input in sorted order
+template<class T>
+std::optional<std::string> check_heap(const std::pmr::vector<T>& input)
+{
+	std::pmr::vector<T> expected(input.begin(), input.end());
+	std::sort(expected.begin(), expected.end());
+
+	std::pmr::vector<T> heap;
+	for (const T& x : input)
+		push_heap(heap, x);
+
+	for (const T& x : expected)
+	{
+		if (heap.empty())
+			return "heap ran out of elements";
+		if (!equivalent(erase_min_heap(heap), x))
+			return "erase_min_heap popped out of order";
+	}
+	if (!heap.empty())
+		return "heap has leftover elements";
+	return std::nullopt;
+}
+
+//Greedily drops chunks of the input, then simplifies integer values,
+//as long as fails(input) keeps returning true
+template<class T, class Fails>
+std::pmr::vector<T> shrink_failing_input(std::pmr::vector<T> input, Fails&& fails)
+{
+	for (size_t chunk = input.size() / 2; chunk >= 1; chunk /= 2)
+	{
+		for (size_t i = 0; i + chunk <= input.size();)
+		{
+			std::pmr::vector<T> candidate(input.begin(), input.begin() + i);
+			candidate.insert(candidate.end(), input.begin() + i + chunk, input.end());
+			if (fails(candidate))
+				input = std::move(candidate);
+			else
+				i += chunk;
+		}
+	}
+
+	if constexpr (std::integral<T>)
+	{
+		for (size_t i = 0; i < input.size(); ++i)
+		{
+			while (input[i] != 0)
+			{
+				std::pmr::vector<T> candidate = input;
+				candidate[i] = input[i] / 2;
+				if (!fails(candidate))
+					break;
+				input = std::move(candidate);
+			}
+		}
+	}
+
+	return input;
+}
+
+#endif //!_SORT_TEST_DIFFERENTIAL_HPP_
@@ -0,0 +1,75 @@
+
+//libFuzzer entry point, build with clang++ -std=c++20 -fsanitize=fuzzer,address sort_fuzz.cpp
+//Not part of the Visual Studio build
+
+#include "differential.hpp"
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+
+template<class T>
+void fuzz_checks(const std::pmr::vector<T>& input, size_t nth)
+{
+	auto require = [&](const char* routine, const std::optional<std::string>& error)
+	{
+		if (!error)
+			return;
+		std::cerr << routine << ": " << *error << " (n = " << input.size() << ")" << std::endl;
+		std::abort();
+	};
+
+	for_each_sort<T>([&]
+	(sort_traits traits, sort_function_t<T> sort)
+	{
+		require(traits.name, check_sort(traits, sort, input));
+	});
+
+	require("quickselect", check_quickselect(input, input.empty() ? 0 : nth % input.size()));
+	require("heap", check_heap(input));
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	if (size < 1)
+		return 0;
+
+	//First byte picks the element type and the nth element for quickselect
+	const uint8_t selector = data[0];
+	++data;
+	--size;
+
+	const size_t count = size / sizeof(uint32_t);
+	std::pmr::vector<uint32_t> keys(count);
+	if (count != 0)
+		memcpy(keys.data(), data, count * sizeof(uint32_t));
+
+	switch (selector % 3)
+	{
+	case 0:
+		fuzz_checks(keys, selector);
+		break;
+
+	case 1:
+	{
+		std::pmr::vector<uint64_t> wide(keys.begin(), keys.end());
+		for (size_t i = 0; i + 1 < wide.size(); i += 2)
+			wide[i] = wide[i] << 32 | wide[i + 1];
+		fuzz_checks(wide, selector);
+		break;
+	}
+
+	case 2:
+	{
+		//Small keys produce many equivalent records, which exercises stability
+		std::pmr::vector<keyed_record> records;
+		for (size_t i = 0; i < keys.size(); ++i)
+			records.push_back({ keys[i] % 16, (uint32_t)i });
+		fuzz_checks(records, selector);
+		break;
+	}
+	}
+
+	return 0;
+}
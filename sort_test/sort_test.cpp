@@ -0,0 +1,197 @@
+
+#include "differential.hpp"
+#include "../sort_bench/inputs.hpp"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <random>
+#include <limits>
+
+
+//Inputs known to break partitioning and digit handling, on top of the benchmark distributions
+enum class adversarial_input
+{
+	all_equal,
+	alternating,
+	sawtooth,
+	nearly_sorted,
+	extremes,
+};
+
+inline constexpr adversarial_input all_adversarial_inputs[] =
+{
+	adversarial_input::all_equal,
+	adversarial_input::alternating,
+	adversarial_input::sawtooth,
+	adversarial_input::nearly_sorted,
+	adversarial_input::extremes,
+};
+
+template<std::integral T>
+void generate_adversarial(std::pmr::vector<T>& v, size_t n, adversarial_input kind, uint64_t seed)
+{
+	std::mt19937_64 rng(seed);
+	constexpr T lo = std::numeric_limits<T>::min();
+	constexpr T hi = std::numeric_limits<T>::max();
+
+	v.clear();
+	for (size_t i = 0; i < n; ++i)
+	{
+		switch (kind)
+		{
+		case adversarial_input::all_equal: v.push_back(T(seed)); break;
+		case adversarial_input::alternating: v.push_back(i % 2 ? hi : lo); break;
+		case adversarial_input::sawtooth: v.push_back(T(i % 17)); break;
+		case adversarial_input::nearly_sorted: v.push_back(T(i)); break;
+		case adversarial_input::extremes: v.push_back(std::array{ lo, hi, T(lo + 1), T(hi - 1), T(0) }[rng() % 5]); break;
+		}
+	}
+
+	if (kind == adversarial_input::nearly_sorted && n > 1)
+		for (size_t i = 0; i < n / 32 + 1; ++i)
+			std::swap(v[rng() % n], v[rng() % n]);
+}
+
+struct test_options
+{
+	uint64_t seed = 1;
+	size_t iterations = 200;
+	size_t max_size = 2000;
+};
+
+class test_runner
+{
+	size_t checks = 0;
+	size_t failures = 0;
+
+public:
+	template<class T, class Check>
+	void run(const char* routine, const char* type_name, const char* input_name, uint64_t seed,
+		const std::pmr::vector<T>& input, Check&& check)
+	{
+		++checks;
+		auto error = check(input);
+		if (!error)
+			return;
+
+		++failures;
+		auto fails = [&](const std::pmr::vector<T>& v) { return check(v).has_value(); };
+		const auto minimal = shrink_failing_input(input, fails);
+
+		std::cout << "FAIL " << routine << " on " << type_name << ", " << input_name <<
+			", seed " << seed << ", n = " << input.size() << ": " << *error << "\n";
+		std::cout << "  minimal input (" << minimal.size() << " elements):";
+		if constexpr (std::integral<T>)
+			for (const T& x : minimal)
+				std::cout << ' ' << +x;
+		else if constexpr (std::same_as<T, std::string>)
+			for (const T& x : minimal)
+				std::cout << " \"" << x << '"';
+		else
+			for (const T& x : minimal)
+				std::cout << " {" << x.key << ", " << x.index << '}';
+		std::cout << std::endl;
+	}
+
+	template<class T>
+	void run_all(const char* type_name, const char* input_name, uint64_t seed, const std::pmr::vector<T>& input)
+	{
+		for_each_sort<T>([&]
+		(sort_traits traits, sort_function_t<T> sort)
+		{
+			run(traits.name, type_name, input_name, seed, input,
+				[&](const std::pmr::vector<T>& v) { return check_sort(traits, sort, v); });
+		});
+
+		const size_t nth = input.empty() ? 0 : seed % input.size();
+		run("quickselect", type_name, input_name, seed, input,
+			[&](const std::pmr::vector<T>& v) { return check_quickselect(v, std::min(nth, v.size() - !v.empty())); });
+		run("heap", type_name, input_name, seed, input,
+			[&](const std::pmr::vector<T>& v) { return check_heap(v); });
+	}
+
+	size_t total_checks() const { return checks; }
+	size_t total_failures() const { return failures; }
+};
+
+template<class T>
+void test_type(const char* type_name, const test_options& opt, test_runner& runner)
+{
+	std::mt19937_64 rng(opt.seed);
+	std::pmr::vector<T> input;
+
+	for (size_t it = 0; it < opt.iterations; ++it)
+	{
+		//Mostly small sizes, where edge cases live, with an occasional large one
+		const size_t n = it % 16 == 15 ? opt.max_size * 8 : rng() % (opt.max_size + 1);
+		const uint64_t seed = rng();
+
+		for (input_distribution dist : all_input_distributions)
+		{
+			generate_input(input, n, dist, seed);
+			runner.run_all(type_name, input_distribution_name(dist), seed, input);
+		}
+
+		if constexpr (std::integral<T>)
+		{
+			for (adversarial_input kind : all_adversarial_inputs)
+			{
+				generate_adversarial(input, n, kind, seed);
+				runner.run_all(type_name, "adversarial", seed, input);
+			}
+		}
+	}
+}
+
+//Keys from few distinct values, so that stable sorts are actually tested for stability
+void test_stability(const test_options& opt, test_runner& runner)
+{
+	std::mt19937_64 rng(opt.seed);
+	std::pmr::vector<keyed_record> input;
+
+	for (size_t it = 0; it < opt.iterations; ++it)
+	{
+		const size_t n = rng() % (opt.max_size + 1);
+		const uint64_t seed = rng();
+		const uint32_t distinct_keys = uint32_t(seed % 64 + 1);
+
+		input.clear();
+		for (size_t i = 0; i < n; ++i)
+			input.push_back({ uint32_t(rng() % distinct_keys), (uint32_t)i });
+
+		runner.run_all("keyed_record", "few_keys", seed, input);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	test_options opt;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		const size_t eq = arg.find('=');
+		const std::string_view key = arg.substr(0, eq);
+		const std::string value(eq == arg.npos ? "" : arg.substr(eq + 1));
+
+		if (key == "--seed") opt.seed = std::stoull(value);
+		else if (key == "--iterations") opt.iterations = std::stoull(value);
+		else if (key == "--max-size") opt.max_size = std::stoull(value);
+		else
+		{
+			std::cerr << "Usage: sort_test [--seed=N] [--iterations=N] [--max-size=N]\n";
+			return 1;
+		}
+	}
+
+	test_runner runner;
+	test_type<uint32_t>("uint32", opt, runner);
+	test_type<uint64_t>("uint64", opt, runner);
+	test_type<int32_t>("int32", opt, runner);
+	test_type<std::string>("string", opt, runner);
+	test_stability(opt, runner);
+
+	std::cout << runner.total_checks() << " checks, " << runner.total_failures() << " failures\n";
+	return runner.total_failures() != 0;
+}
@@ -0,0 +1,134 @@
+
+#ifndef _KSN_SORT_AUTOTUNE_HPP_
+#define _KSN_SORT_AUTOTUNE_HPP_
+
+//Benchmarks candidate sort parameters on this machine and picks the fastest for every
+//element size and input size class. Separate from sort_tuning.hpp so that the sorts don't pull it in
+
+#include <vector>
+#include <random>
+#include <chrono>
+#include <ostream>
+#include <algorithm>
+
+#include <stdint.h>
+
+#include "sort_tuning.hpp"
+#include "../american_flag_sort/afsort.hpp"
+#include "../radix_sort/radix_sort.hpp"
+#include "../select/quick_sort.hpp"
+
+
+_KSN_BEGIN
+
+namespace sort_tuning
+{
+	struct autotune_options
+	{
+		//Input size classes above this one keep their current parameters
+		size_t max_input_class = input_size_classes - 1;
+		size_t runs = 3;
+		uint64_t seed = 1;
+		std::ostream* log = nullptr;
+	};
+
+	_KSN_DETAIL_BEGIN
+
+	//Fastest of the runs in nanoseconds per element. Small inputs are sorted as a batch of copies
+	template<class T, class Sort>
+	double time_sort(const std::vector<T>& input, size_t runs, Sort&& sort)
+	{
+		static constexpr size_t min_batch_elements = 1 << 16;
+		const size_t n = input.size();
+		const size_t copies = std::max<size_t>(1, min_batch_elements / n);
+		std::vector<T> work(n * copies);
+
+		double best = 1e300;
+		for (size_t run = 0; run < runs; ++run)
+		{
+			for (size_t i = 0; i < copies; ++i)
+				std::copy(input.begin(), input.end(), work.begin() + i * n);
+
+			const auto t1 = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < copies; ++i)
+				sort(work.begin() + i * n, work.begin() + (i + 1) * n);
+			const auto t2 = std::chrono::steady_clock::now();
+
+			best = std::min(best, std::chrono::duration<double, std::nano>(t2 - t1).count() / (n * copies));
+		}
+		return best;
+	}
+
+	//Sets the parameter to every candidate in turn and keeps the fastest one
+	template<class T, class Value, size_t N, class Sort>
+	void tune_parameter(Value& parameter, const Value(&candidates)[N], const char* name,
+		const std::vector<T>& input, const autotune_options& opt, Sort&& sort)
+	{
+		Value best_value = parameter;
+		double best_time = 1e300;
+		for (Value candidate : candidates)
+		{
+			parameter = candidate;
+			const double t = time_sort(input, opt.runs, sort);
+			if (t < best_time)
+			{
+				best_time = t;
+				best_value = candidate;
+			}
+		}
+		parameter = best_value;
+
+		if (opt.log)
+			*opt.log << name << ": " << sizeof(T) << " byte elements, n = " << input.size() <<
+				": " << +best_value << " (" << best_time << " ns/element)\n";
+	}
+
+	template<std::unsigned_integral T>
+	void tune_element_type(const autotune_options& opt)
+	{
+		static constexpr uint8_t afsort_candidates[] = { 3, 4, 5, 6, 7, 8 };
+		static constexpr uint8_t radix_candidates[] = { 4, 5, 6, 7, 8, 9, 10, 11 };
+		static constexpr uint32_t cutoff_candidates[] = { 1, 4, 8, 12, 16, 24, 32, 48, 64 };
+
+		std::mt19937_64 rng(opt.seed);
+		std::vector<T> input;
+
+		for (size_t size_class = 0; size_class <= opt.max_input_class && size_class < input_size_classes; ++size_class)
+		{
+			input.resize(input_size_class_sample(size_class));
+			for (T& x : input)
+				x = (T)rng();
+
+			parameters& p = table()[element_size_class(sizeof(T))][size_class];
+			auto afsort_f = [](auto begin, auto end) { afsort(begin, end); };
+			auto radix_f = [](auto begin, auto end) { radix_sort(begin, end); };
+			auto quick_f = [](auto begin, auto end) { quick_sort(begin, end); };
+
+			tune_parameter(p.afsort_base_log2, afsort_candidates, "afsort_base_log2", input, opt, afsort_f);
+			tune_parameter(p.radix_sort_base_log2, radix_candidates, "radix_sort_base_log2", input, opt, radix_f);
+			tune_parameter(p.quick_sort_cutoff, cutoff_candidates, "quick_sort_cutoff", input, opt, quick_f);
+		}
+	}
+
+	_KSN_DETAIL_END
+
+	//Tunes the process-wide table in place and returns it.
+	//Must not run concurrently with sorts in other threads
+	inline const parameters_table& autotune(const autotune_options& opt = {})
+	{
+		detail::tune_element_type<uint8_t>(opt);
+		detail::tune_element_type<uint16_t>(opt);
+		detail::tune_element_type<uint32_t>(opt);
+		detail::tune_element_type<uint64_t>(opt);
+		return table();
+	}
+
+	inline bool autotune_and_save(const char* path = default_file(), const autotune_options& opt = {})
+	{
+		return save(autotune(opt), path);
+	}
+}
+
+_KSN_END
+
+#endif //!_KSN_SORT_AUTOTUNE_HPP_
@@ -0,0 +1,48 @@
+
+#include "autotune.hpp"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+
+int main(int argc, char** argv)
+{
+	ksn::sort_tuning::autotune_options opt;
+	opt.log = &std::cout;
+	std::string output = ksn::sort_tuning::default_file();
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+		const size_t eq = arg.find('=');
+		const std::string_view key = arg.substr(0, eq);
+		const std::string value(eq == arg.npos ? "" : arg.substr(eq + 1));
+
+		if (key == "--output") output = value;
+		else if (key == "--max-class") opt.max_input_class = std::stoull(value);
+		else if (key == "--runs") opt.runs = std::stoull(value);
+		else if (key == "--seed") opt.seed = std::stoull(value);
+		else
+		{
+			std::cerr <<
+				"Usage: sort_tune [options]\n"
+				"  --output=PATH    parameter file (KSN_SORT_TUNING_FILE or ksn_sort_tuning.cfg)\n"
+				"  --max-class=N    only tune input size classes up to N, 0 to 3 (3)\n"
+				"  --runs=N         timed runs per candidate (3)\n"
+				"  --seed=N         input seed (1)\n";
+			return 1;
+		}
+	}
+
+	if (opt.runs == 0)
+		opt.runs = 1;
+
+	if (!ksn::sort_tuning::autotune_and_save(output.c_str(), opt))
+	{
+		std::cerr << "Failed to write " << output << "\n";
+		return 1;
+	}
+	std::cout << "Saved to " << output << "\n";
+	return 0;
+}
@@ -0,0 +1,151 @@
+
+#ifndef _KSN_SORT_TUNING_HPP_
+#define _KSN_SORT_TUNING_HPP_
+
+//Per-machine sort parameters, picked by the autotuner (autotune.hpp) and read by the sort dispatchers.
+//Parameters are kept per element size (1, 2, 4, 8 bytes) and input size class. On first use the table is only
+//loaded from the file named by the KSN_SORT_TUNING_FILE environment variable, a program that wants default_file()
+//calls load_default() at startup. Missing file or entries keep the hand-picked defaults
+
+#include <array>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+#include <stdint.h>
+
+#include <ksn/ksn.hpp>
+
+
+_KSN_BEGIN
+
+namespace sort_tuning
+{
+	//Hard limits, these size the bucket arrays
+	static constexpr uint8_t afsort_max_base_log2 = 8;
+	static constexpr uint8_t radix_sort_max_base_log2 = 11;
+
+	struct parameters
+	{
+		uint8_t afsort_base_log2 = 4;
+		uint8_t radix_sort_base_log2 = 8;
+		uint32_t quick_sort_cutoff = 16;
+	};
+
+	static constexpr size_t element_size_classes = 4;
+	static constexpr size_t input_size_classes = 4;
+
+	//Element sizes are 1, 2, 4 and 8 bytes or more
+	constexpr size_t element_size_class(size_t element_size)
+	{
+		return element_size <= 1 ? 0 : element_size <= 2 ? 1 : element_size <= 4 ? 2 : 3;
+	}
+
+	//Input sizes are below 1K, 64K, 4M elements and everything larger
+	constexpr size_t input_size_class(size_t n)
+	{
+		return n < (1 << 10) ? 0 : n < (1 << 16) ? 1 : n < (1 << 22) ? 2 : 3;
+	}
+
+	//Representative input size of each class, used by the autotuner
+	constexpr size_t input_size_class_sample(size_t size_class)
+	{
+		constexpr size_t samples[input_size_classes] = { 300, 20'000, 1'000'000, 8'000'000 };
+		return samples[size_class];
+	}
+
+	using parameters_table = std::array<std::array<parameters, input_size_classes>, element_size_classes>;
+
+	//KSN_SORT_TUNING_FILE if set, otherwise ksn_sort_tuning.cfg in the working directory
+	inline const char* default_file()
+	{
+		const char* path = std::getenv("KSN_SORT_TUNING_FILE");
+		return path && *path ? path : "ksn_sort_tuning.cfg";
+	}
+
+	//One "<name> <element size class> <input size class> <value>" per line, # starts a comment.
+	//Unknown names and out-of-range values are skipped. Returns false if the file could not be opened
+	inline bool load(parameters_table& table, const char* path)
+	{
+		std::ifstream in(path);
+		if (!in)
+			return false;
+
+		std::string line;
+		while (std::getline(in, line))
+		{
+			std::istringstream fields(line.substr(0, line.find('#')));
+			std::string name;
+			size_t elem = 0, input = 0;
+			uint64_t value = 0;
+			if (!(fields >> name >> elem >> input >> value) || elem >= element_size_classes || input >= input_size_classes)
+				continue;
+
+			parameters& p = table[elem][input];
+			if (name == "afsort_base_log2" && value >= 1 && value <= afsort_max_base_log2)
+				p.afsort_base_log2 = (uint8_t)value;
+			else if (name == "radix_sort_base_log2" && value >= 1 && value <= radix_sort_max_base_log2)
+				p.radix_sort_base_log2 = (uint8_t)value;
+			else if (name == "quick_sort_cutoff" && value <= UINT32_MAX)
+				p.quick_sort_cutoff = (uint32_t)value;
+		}
+		return true;
+	}
+
+	inline bool save(const parameters_table& table, const char* path)
+	{
+		std::ofstream out(path);
+		out << "# ksn sort parameters: <name> <element size class> <input size class> <value>\n";
+		for (size_t elem = 0; elem < element_size_classes; ++elem)
+		{
+			for (size_t input = 0; input < input_size_classes; ++input)
+			{
+				const parameters& p = table[elem][input];
+				out << "afsort_base_log2 " << elem << ' ' << input << ' ' << +p.afsort_base_log2 << '\n';
+				out << "radix_sort_base_log2 " << elem << ' ' << input << ' ' << +p.radix_sort_base_log2 << '\n';
+				out << "quick_sort_cutoff " << elem << ' ' << input << ' ' << p.quick_sort_cutoff << '\n';
+			}
+		}
+		return bool(out);
+	}
+
+	//Process-wide table. Replace it before sorting from other threads.
+	//Reached from noexcept sorts, so a failed load falls back to the defaults instead of throwing
+	inline parameters_table& table()
+	{
+		static parameters_table instance = []() noexcept
+		{
+			parameters_table t{};
+			const char* path = std::getenv("KSN_SORT_TUNING_FILE");
+			if (path && *path)
+			{
+				try
+				{
+					load(t, path);
+				}
+				catch (...)
+				{
+					t = {};
+				}
+			}
+			return t;
+		}();
+		return instance;
+	}
+
+	//Loads default_file() into the process-wide table. Call before sorting from other threads
+	inline bool load_default()
+	{
+		return load(table(), default_file());
+	}
+
+	inline const parameters& get(size_t element_size, size_t n)
+	{
+		return table()[element_size_class(element_size)][input_size_class(n)];
+	}
+}
+
+_KSN_END
+
+#endif //!_KSN_SORT_TUNING_HPP_
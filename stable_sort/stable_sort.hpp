@@ -0,0 +1,201 @@
+
+#ifndef _STABLE_SORT_HPP_
+#define _STABLE_SORT_HPP_
+
+#include <iterator>
+#include <concepts>
+#include <functional>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+#include <cstddef>
+
+#include "../rotate/rotate.hpp"
+
+
+//Runs of this length are sorted by insertion sort before merging starts
+static constexpr size_t _stable_sort_block_size = 20;
+
+
+
+template<std::random_access_iterator Iter, class Comp>
+void _stable_insertion_sort(Iter first, Iter end, Comp& comp)
+{
+	if (end - first <= 1)
+		return;
+
+	for (Iter p = first + 1; p != end; ++p)
+	{
+		if (!comp(*p, *(p - 1)))
+			continue;
+
+		auto x = std::move(*p);
+		Iter q = p;
+		do
+		{
+			*q = std::move(*(q - 1));
+			--q;
+		} while (q != first && comp(x, *(q - 1)));
+		*q = std::move(x);
+	}
+}
+
+//Merges [first, mid) and [mid, end) moving the shorter run into the buffer.
+//Requires buffer.capacity() >= min(mid - first, end - mid)
+template<std::random_access_iterator Iter, class Comp, class T>
+void _buffered_merge(Iter first, Iter mid, Iter end, Comp& comp, std::vector<T>& buffer)
+{
+	if (mid - first <= end - mid)
+	{
+		std::move(first, mid, std::back_inserter(buffer));
+
+		auto b = buffer.begin();
+		auto r = mid;
+		auto out = first;
+		while (b != buffer.end() && r != end)
+		{
+			if (comp(*r, *b))
+				*out++ = std::move(*r++);
+			else
+				*out++ = std::move(*b++);
+		}
+		std::move(b, buffer.end(), out);
+	}
+	else
+	{
+		std::move(mid, end, std::back_inserter(buffer));
+
+		auto b = buffer.end();
+		auto l = mid;
+		auto out = end;
+		while (b != buffer.begin() && l != first)
+		{
+			if (comp(*(b - 1), *(l - 1)))
+				*--out = std::move(*--l);
+			else
+				*--out = std::move(*--b);
+		}
+		std::move_backward(buffer.begin(), b, out);
+	}
+	buffer.clear();
+}
+
+//SymMerge (Kim & Kutzner, 2004), O(log n) recursion depth, no extra memory besides xrotate's.
+//If a buffer is passed, sub-merges with a short enough run go through it instead
+template<std::random_access_iterator Iter, class Comp, class T = std::iter_value_t<Iter>>
+void _symmerge(Iter first, Iter mid, Iter end, Comp& comp, std::vector<T>* buffer = nullptr)
+{
+	while (true)
+	{
+		const size_t n1 = mid - first;
+		const size_t n2 = end - mid;
+		if (n1 == 0 || n2 == 0 || !comp(*mid, *(mid - 1)))
+			return;
+
+		if (buffer && std::min(n1, n2) <= buffer->capacity())
+			return _buffered_merge(first, mid, end, comp, *buffer);
+
+		if (n1 == 1)
+		{
+			Iter p = std::lower_bound(mid, end, *first, comp);
+			return xrotate(first, mid, p);
+		}
+		if (n2 == 1)
+		{
+			Iter p = std::upper_bound(first, mid, *mid, comp);
+			return xrotate(p, mid, end);
+		}
+
+		//Find the largest l such that the l last elements of the left run
+		//all go after the l first elements of the right run, symmetric around the middle
+		const size_t half = (n1 + n2) / 2;
+		const size_t n = half + n1;
+		size_t lo, hi;
+		if (n1 > half)
+		{
+			lo = n - (n1 + n2);
+			hi = half;
+		}
+		else
+		{
+			lo = 0;
+			hi = n1;
+		}
+		while (lo < hi)
+		{
+			const size_t c = lo + (hi - lo) / 2;
+			if (!comp(first[n - 1 - c], first[c]))
+				lo = c + 1;
+			else
+				hi = c;
+		}
+
+		const Iter start = first + lo;
+		const Iter finish = first + (n - lo);
+		const Iter center = first + half;
+
+		xrotate(start, mid, finish);
+
+		//Recurse into the smaller half, loop on the larger one
+		if (center - first <= end - center)
+		{
+			_symmerge(first, start, center, comp, buffer);
+			first = center;
+			mid = finish;
+		}
+		else
+		{
+			_symmerge(center, finish, end, comp, buffer);
+			end = center;
+			mid = start;
+		}
+	}
+}
+
+template<std::random_access_iterator Iter, class Comp, class T = std::iter_value_t<Iter>>
+void _merge_sort_bottom_up(Iter first, Iter end, Comp& comp, std::vector<T>* buffer)
+{
+	const size_t n = end - first;
+
+	for (size_t i = 0; i < n; i += _stable_sort_block_size)
+		_stable_insertion_sort(first + i, first + std::min(i + _stable_sort_block_size, n), comp);
+
+	for (size_t width = _stable_sort_block_size; width < n; width *= 2)
+	{
+		for (size_t i = 0; i + width < n; i += 2 * width)
+			_symmerge(first + i, first + i + width, first + std::min(i + 2 * width, n), comp, buffer);
+	}
+}
+
+
+
+//Stable in-place merge of [first, mid) and [mid, end), O(1) extra memory
+template<std::random_access_iterator Iter, class Comp = std::less<>>
+void symmerge(Iter first, Iter mid, Iter end, Comp comp = {})
+{
+	_symmerge(first, mid, end, comp);
+}
+
+//Stable in-place sort, O(1) extra memory, O(n log^2 n) moves
+template<std::random_access_iterator Iter, class Comp = std::less<>>
+void symmerge_sort(Iter first, Iter end, Comp comp = {})
+{
+	_merge_sort_bottom_up(first, end, comp, (std::vector<std::iter_value_t<Iter>>*)nullptr);
+}
+
+//Stable sort with an O(sqrt n) buffer. Merges of short runs are done linearly through it,
+//long merges are split by SymMerge until they get short enough
+template<std::random_access_iterator Iter, class Comp = std::less<>>
+void xstable_sort(Iter first, Iter end, Comp comp = {})
+{
+	const size_t n = end - first;
+	if (n <= 1)
+		return;
+
+	std::vector<std::iter_value_t<Iter>> buffer;
+	buffer.reserve((size_t)std::sqrt((double)n) + 1);
+	_merge_sort_bottom_up(first, end, comp, &buffer);
+}
+
+#endif //!_STABLE_SORT_HPP_
@@ -0,0 +1,87 @@
+
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include "stable_sort.hpp"
+
+
+struct noop { constexpr void operator()(){} };
+
+template<class Callable, class Callable2 = noop>
+uint64_t measure(Callable&& f, size_t times = 1, Callable2&& prep = {})
+{
+	using namespace std;
+	using namespace chrono;
+	auto clock_f = &steady_clock::now;
+	uint64_t dt = UINT64_MAX;
+	for (size_t i = 0; i < times; ++i)
+	{
+		prep();
+		auto t1 = clock_f();
+		f();
+		auto t2 = clock_f();
+		dt = std::min<uint64_t>(dt, duration_cast<nanoseconds>(t2 - t1).count());
+	}
+	return dt;
+}
+
+struct keyed
+{
+	uint32_t key;
+	uint32_t index;
+
+	bool operator==(const keyed&) const = default;
+};
+
+int main()
+{
+	std::mt19937_64 rng;
+
+	for (size_t n = 1000; n <= 10'000'000; n *= 10)
+	{
+		//Few distinct keys so stability actually matters
+		std::uniform_int_distribution<uint32_t> dist(0, uint32_t(n / 16));
+
+		std::vector<keyed> v0(n), v(n), expected(n);
+		for (size_t i = 0; i < n; ++i)
+			v0[i] = { dist(rng), (uint32_t)i };
+
+		auto by_key = [](const keyed& a, const keyed& b) { return a.key < b.key; };
+
+		auto refill = [&] { v = v0; };
+		auto run = [&]
+		(auto&& sort_f, const char* name)
+		{
+			constexpr size_t measures = 3;
+			auto dt = measure([&] { sort_f(v.begin(), v.end(), by_key); }, measures, refill) / 1000;
+			if (v != expected)
+				std::cout << "Error: " << name << " on n = " << n << std::endl;
+			return dt;
+		};
+
+		using Iter = std::vector<keyed>::iterator;
+		expected = v0;
+		std::stable_sort(expected.begin(), expected.end(), by_key);
+
+		std::cout << "n = " << std::setw(8) << n << ": " <<
+			"std::stable_sort " << run([&](Iter a, Iter b, auto c) { std::stable_sort(a, b, c); }, "std::stable_sort") << " us, " <<
+			"xstable_sort " << run([&](Iter a, Iter b, auto c) { xstable_sort(a, b, c); }, "xstable_sort") << " us, " <<
+			"symmerge_sort " << run([&](Iter a, Iter b, auto c) { symmerge_sort(a, b, c); }, "symmerge_sort") << " us\n";
+	}
+
+	std::vector<std::string> strings;
+	for (int i = 0; i < 10000; ++i)
+		strings.push_back(std::to_string(rng() % 1000));
+	auto strings_expected = strings;
+	std::stable_sort(strings_expected.begin(), strings_expected.end());
+	xstable_sort(strings.begin(), strings.end());
+	if (strings != strings_expected)
+		std::cout << "Error: xstable_sort on strings" << std::endl;
+
+	return 0;
+}
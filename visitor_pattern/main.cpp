@@ -16,12 +16,25 @@ auto new_circle(float x, float y, float r)
 	return p;
 }
 
+auto new_square(float x, float y, float side)
+{
+	auto p = std::make_unique<square>();
+	p->pos[0] = x;
+	p->pos[1] = y;
+	p->side = side;
+	return p;
+}
+
 int main()
 {
 	shapes_t shapes;
 	shapes.push_back(new_circle(0, 1, 2));
+	shapes.push_back(new_square(1, 0, 3));
+	shapes.push_back(new_circle(-1, 2, 1));
 
 	shape_visitor_draw dr;
 	for (auto&& p : shapes)
 		p->accept(dr);
+
+	visit_all(shapes, dr);
 }
@@ -2,15 +2,36 @@
 #ifndef _SHAPE_HPP_
 #define _SHAPE_HPP_
 
+#include <span>
+#include <memory>
+#include <vector>
+
+#include <stdint.h>
+
 class shape_visitor;
 class shape;
 
+enum class shape_kind : uint8_t
+{
+	circle,
+	square,
+};
+
 class shape
 {
 public:
+	//Dynamic type, readable without a virtual call
+	const shape_kind kind;
+
 	virtual ~shape() = 0;
 
 	virtual void accept(shape_visitor&) = 0;
+
+protected:
+	shape(shape_kind kind) noexcept
+		: kind(kind)
+	{
+	}
 };
 
 using vec2f = float[2];
@@ -23,6 +44,11 @@ public:
 	vec2f pos;
 	float radius;
 
+	circle() noexcept
+		: shape(shape_kind::circle)
+	{
+	}
+
 	void accept(shape_visitor&) override;
 };
 
@@ -33,6 +59,11 @@ public:
 	vec2f pos;
 	float side;
 
+	square() noexcept
+		: shape(shape_kind::square)
+	{
+	}
+
 	void accept(shape_visitor&) override;
 };
 
@@ -46,11 +77,36 @@ public:
 	virtual void visit(square&) = 0;
 };
 
-class shape_visitor_draw
+class shape_visitor_draw final
 	: public shape_visitor
 {
+public:
 	void visit(circle&) override;
 	void visit(square&) override;
 };
 
+
+
+//Batched dispatch: shapes are grouped by kind first, then the visitor is called
+//in one loop per type. With a final Visitor the calls are resolved statically
+template<class Visitor>
+void visit_all(std::span<const std::unique_ptr<shape>> shapes, Visitor& visitor)
+{
+	std::vector<circle*> circles;
+	std::vector<square*> squares;
+
+	for (auto&& p : shapes)
+	{
+		if (p->kind == shape_kind::circle)
+			circles.push_back(static_cast<circle*>(p.get()));
+		else
+			squares.push_back(static_cast<square*>(p.get()));
+	}
+
+	for (circle* p : circles)
+		visitor.visit(*p);
+	for (square* p : squares)
+		visitor.visit(*p);
+}
+
 #endif //!_SHAPE_HPP_
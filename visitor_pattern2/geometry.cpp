@@ -0,0 +1,435 @@
+
+#include "geometry.hpp"
+#include "shape_store.hpp"
+
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define _GEOMETRY_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define _GEOMETRY_TARGET_AVX2
+#else
+#define _GEOMETRY_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#else
+#define _GEOMETRY_X86 0
+#endif
+
+
+namespace
+{
+	//Every kernel processes elements [0, n) of its arrays
+
+	struct geometry_kernel_table
+	{
+		const char* isa;
+
+		double (*sum_squares)(const float* v, size_t n);
+		void (*bounds)(const float* x, const float* y, const float* extent, float extent_scale,
+			size_t n, aabb& box);
+		void (*circles_containing)(const float* x, const float* y, const float* r,
+			size_t n, float px, float py, std::vector<uint32_t>& result);
+		void (*squares_containing)(const float* x, const float* y, const float* side,
+			size_t n, float px, float py, std::vector<uint32_t>& result);
+		void (*squares_overlapping_circle)(const float* x, const float* y, const float* side,
+			size_t n, float cx, float cy, float r, std::vector<uint32_t>& result);
+		void (*circles_overlapping_square)(const float* x, const float* y, const float* r,
+			size_t n, float sx, float sy, float half_side, std::vector<uint32_t>& result);
+	};
+
+
+
+	double sum_squares_scalar(const float* v, size_t n)
+	{
+		double sum = 0;
+		for (size_t i = 0; i < n; ++i)
+			sum += double(v[i]) * v[i];
+		return sum;
+	}
+
+	void bounds_scalar(const float* x, const float* y, const float* extent, float extent_scale,
+		size_t n, aabb& box)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			const float e = extent[i] * extent_scale;
+			box.min[0] = std::min(box.min[0], x[i] - e);
+			box.min[1] = std::min(box.min[1], y[i] - e);
+			box.max[0] = std::max(box.max[0], x[i] + e);
+			box.max[1] = std::max(box.max[1], y[i] + e);
+		}
+	}
+
+	void circles_containing_scalar(const float* x, const float* y, const float* r,
+		size_t n, float px, float py, std::vector<uint32_t>& result)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			const float dx = x[i] - px;
+			const float dy = y[i] - py;
+			if (dx * dx + dy * dy <= r[i] * r[i])
+				result.push_back((uint32_t)i);
+		}
+	}
+
+	void squares_containing_scalar(const float* x, const float* y, const float* side,
+		size_t n, float px, float py, std::vector<uint32_t>& result)
+	{
+		for (size_t i = 0; i < n; ++i)
+		{
+			const float h = side[i] * 0.5f;
+			if (std::abs(x[i] - px) <= h && std::abs(y[i] - py) <= h)
+				result.push_back((uint32_t)i);
+		}
+	}
+
+	//Distance from the circle's center to the closest point of the square, squared
+	float circle_square_distance2(float dx, float dy, float half_side)
+	{
+		dx = std::max(std::abs(dx) - half_side, 0.f);
+		dy = std::max(std::abs(dy) - half_side, 0.f);
+		return dx * dx + dy * dy;
+	}
+
+	void squares_overlapping_circle_scalar(const float* x, const float* y, const float* side,
+		size_t n, float cx, float cy, float r, std::vector<uint32_t>& result)
+	{
+		for (size_t i = 0; i < n; ++i)
+			if (circle_square_distance2(x[i] - cx, y[i] - cy, side[i] * 0.5f) <= r * r)
+				result.push_back((uint32_t)i);
+	}
+
+	void circles_overlapping_square_scalar(const float* x, const float* y, const float* r,
+		size_t n, float sx, float sy, float half_side, std::vector<uint32_t>& result)
+	{
+		for (size_t i = 0; i < n; ++i)
+			if (circle_square_distance2(x[i] - sx, y[i] - sy, half_side) <= r[i] * r[i])
+				result.push_back((uint32_t)i);
+	}
+
+	constexpr geometry_kernel_table scalar_kernels
+	{
+		"scalar",
+		sum_squares_scalar,
+		bounds_scalar,
+		circles_containing_scalar,
+		squares_containing_scalar,
+		squares_overlapping_circle_scalar,
+		circles_overlapping_square_scalar,
+	};
+
+
+
+#if _GEOMETRY_X86
+
+	//Runs a scalar kernel on the elements from i on, left over by a vector loop, and offsets the indices it appended
+	template<class Kernel>
+	void scalar_tail(size_t i, std::vector<uint32_t>& result, Kernel&& kernel)
+	{
+		const size_t first = result.size();
+		kernel();
+		for (size_t k = first; k < result.size(); ++k)
+			result[k] += (uint32_t)i;
+	}
+
+	_GEOMETRY_TARGET_AVX2
+	void append_mask_indices(int mask, size_t base, std::vector<uint32_t>& result)
+	{
+		unsigned bits = (unsigned)mask;
+		while (bits)
+		{
+			result.push_back(uint32_t(base + std::countr_zero(bits)));
+			bits &= bits - 1;
+		}
+	}
+
+	_GEOMETRY_TARGET_AVX2
+	__m256 abs_avx2(__m256 x)
+	{
+		return _mm256_andnot_ps(_mm256_set1_ps(-0.f), x);
+	}
+
+	_GEOMETRY_TARGET_AVX2
+	double sum_squares_avx2(const float* v, size_t n)
+	{
+		__m256d acc0 = _mm256_setzero_pd();
+		__m256d acc1 = _mm256_setzero_pd();
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			const __m256 x = _mm256_loadu_ps(v + i);
+			const __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+			const __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+			acc0 = _mm256_fmadd_pd(lo, lo, acc0);
+			acc1 = _mm256_fmadd_pd(hi, hi, acc1);
+		}
+
+		alignas(32) double lanes[4];
+		_mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+		return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum_squares_scalar(v + i, n - i);
+	}
+
+	_GEOMETRY_TARGET_AVX2
+	void bounds_avx2(const float* x, const float* y, const float* extent, float extent_scale,
+		size_t n, aabb& box)
+	{
+		__m256 min_x = _mm256_set1_ps(box.min[0]);
+		__m256 min_y = _mm256_set1_ps(box.min[1]);
+		__m256 max_x = _mm256_set1_ps(box.max[0]);
+		__m256 max_y = _mm256_set1_ps(box.max[1]);
+		const __m256 scale = _mm256_set1_ps(extent_scale);
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			const __m256 vx = _mm256_loadu_ps(x + i);
+			const __m256 vy = _mm256_loadu_ps(y + i);
+			const __m256 e = _mm256_mul_ps(_mm256_loadu_ps(extent + i), scale);
+			min_x = _mm256_min_ps(min_x, _mm256_sub_ps(vx, e));
+			min_y = _mm256_min_ps(min_y, _mm256_sub_ps(vy, e));
+			max_x = _mm256_max_ps(max_x, _mm256_add_ps(vx, e));
+			max_y = _mm256_max_ps(max_y, _mm256_add_ps(vy, e));
+		}
+
+		alignas(32) float lanes[4][8];
+		_mm256_store_ps(lanes[0], min_x);
+		_mm256_store_ps(lanes[1], min_y);
+		_mm256_store_ps(lanes[2], max_x);
+		_mm256_store_ps(lanes[3], max_y);
+		for (int j = 0; j < 8; ++j)
+		{
+			box.min[0] = std::min(box.min[0], lanes[0][j]);
+			box.min[1] = std::min(box.min[1], lanes[1][j]);
+			box.max[0] = std::max(box.max[0], lanes[2][j]);
+			box.max[1] = std::max(box.max[1], lanes[3][j]);
+		}
+
+		bounds_scalar(x + i, y + i, extent + i, extent_scale, n - i, box);
+	}
+
+	_GEOMETRY_TARGET_AVX2
+	void circles_containing_avx2(const float* x, const float* y, const float* r,
+		size_t n, float px, float py, std::vector<uint32_t>& result)
+	{
+		const __m256 vpx = _mm256_set1_ps(px);
+		const __m256 vpy = _mm256_set1_ps(py);
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + i), vpx);
+			const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + i), vpy);
+			const __m256 vr = _mm256_loadu_ps(r + i);
+			const __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+			const __m256 inside = _mm256_cmp_ps(d2, _mm256_mul_ps(vr, vr), _CMP_LE_OQ);
+			append_mask_indices(_mm256_movemask_ps(inside), i, result);
+		}
+
+		scalar_tail(i, result, [&] { circles_containing_scalar(x + i, y + i, r + i, n - i, px, py, result); });
+	}
+
+	_GEOMETRY_TARGET_AVX2
+	void squares_containing_avx2(const float* x, const float* y, const float* side,
+		size_t n, float px, float py, std::vector<uint32_t>& result)
+	{
+		const __m256 vpx = _mm256_set1_ps(px);
+		const __m256 vpy = _mm256_set1_ps(py);
+		const __m256 half = _mm256_set1_ps(0.5f);
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			const __m256 h = _mm256_mul_ps(_mm256_loadu_ps(side + i), half);
+			const __m256 dx = abs_avx2(_mm256_sub_ps(_mm256_loadu_ps(x + i), vpx));
+			const __m256 dy = abs_avx2(_mm256_sub_ps(_mm256_loadu_ps(y + i), vpy));
+			const __m256 inside = _mm256_and_ps(
+				_mm256_cmp_ps(dx, h, _CMP_LE_OQ),
+				_mm256_cmp_ps(dy, h, _CMP_LE_OQ));
+			append_mask_indices(_mm256_movemask_ps(inside), i, result);
+		}
+
+		scalar_tail(i, result, [&] { squares_containing_scalar(x + i, y + i, side + i, n - i, px, py, result); });
+	}
+
+	_GEOMETRY_TARGET_AVX2
+	__m256 circle_square_distance2_avx2(__m256 dx, __m256 dy, __m256 half_side)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		dx = _mm256_max_ps(_mm256_sub_ps(abs_avx2(dx), half_side), zero);
+		dy = _mm256_max_ps(_mm256_sub_ps(abs_avx2(dy), half_side), zero);
+		return _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+	}
+
+	_GEOMETRY_TARGET_AVX2
+	void squares_overlapping_circle_avx2(const float* x, const float* y, const float* side,
+		size_t n, float cx, float cy, float r, std::vector<uint32_t>& result)
+	{
+		const __m256 vcx = _mm256_set1_ps(cx);
+		const __m256 vcy = _mm256_set1_ps(cy);
+		const __m256 r2 = _mm256_set1_ps(r * r);
+		const __m256 half = _mm256_set1_ps(0.5f);
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			const __m256 d2 = circle_square_distance2_avx2(
+				_mm256_sub_ps(_mm256_loadu_ps(x + i), vcx),
+				_mm256_sub_ps(_mm256_loadu_ps(y + i), vcy),
+				_mm256_mul_ps(_mm256_loadu_ps(side + i), half));
+			append_mask_indices(_mm256_movemask_ps(_mm256_cmp_ps(d2, r2, _CMP_LE_OQ)), i, result);
+		}
+
+		scalar_tail(i, result, [&] { squares_overlapping_circle_scalar(x + i, y + i, side + i, n - i, cx, cy, r, result); });
+	}
+
+	_GEOMETRY_TARGET_AVX2
+	void circles_overlapping_square_avx2(const float* x, const float* y, const float* r,
+		size_t n, float sx, float sy, float half_side, std::vector<uint32_t>& result)
+	{
+		const __m256 vsx = _mm256_set1_ps(sx);
+		const __m256 vsy = _mm256_set1_ps(sy);
+		const __m256 h = _mm256_set1_ps(half_side);
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			const __m256 vr = _mm256_loadu_ps(r + i);
+			const __m256 d2 = circle_square_distance2_avx2(
+				_mm256_sub_ps(_mm256_loadu_ps(x + i), vsx),
+				_mm256_sub_ps(_mm256_loadu_ps(y + i), vsy),
+				h);
+			append_mask_indices(_mm256_movemask_ps(_mm256_cmp_ps(d2, _mm256_mul_ps(vr, vr), _CMP_LE_OQ)), i, result);
+		}
+
+		scalar_tail(i, result, [&] { circles_overlapping_square_scalar(x + i, y + i, r + i, n - i, sx, sy, half_side, result); });
+	}
+
+	constexpr geometry_kernel_table avx2_kernels
+	{
+		"avx2",
+		sum_squares_avx2,
+		bounds_avx2,
+		circles_containing_avx2,
+		squares_containing_avx2,
+		squares_overlapping_circle_avx2,
+		circles_overlapping_square_avx2,
+	};
+
+	bool cpu_has_avx2()
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7)
+			return false;
+
+		__cpuid(info, 1);
+		const bool osxsave = info[2] & (1 << 27);
+		const bool avx = info[2] & (1 << 28);
+		const bool fma = info[2] & (1 << 12);
+		if (!osxsave || !avx || !fma || (_xgetbv(0) & 6) != 6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return info[1] & (1 << 5);
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+	}
+
+#endif //_GEOMETRY_X86
+
+
+
+	const geometry_kernel_table*& active_kernels()
+	{
+		static const geometry_kernel_table* table = []
+		() -> const geometry_kernel_table*
+		{
+#if _GEOMETRY_X86
+			if (cpu_has_avx2())
+				return &avx2_kernels;
+#endif
+			return &scalar_kernels;
+		}();
+		return table;
+	}
+
+	const geometry_kernel_table& kernels()
+	{
+		return *active_kernels();
+	}
+}
+
+
+
+void area_operation::operator()(const circle_array& arr)
+{
+	total += std::numbers::pi * kernels().sum_squares(arr.radius.data(), arr.size());
+}
+
+void area_operation::operator()(const square_array& arr)
+{
+	total += kernels().sum_squares(arr.side.data(), arr.size());
+}
+
+void bounds_operation::operator()(const circle_array& arr)
+{
+	kernels().bounds(arr.pos_x.data(), arr.pos_y.data(), arr.radius.data(), 1.f, arr.size(), box);
+}
+
+void bounds_operation::operator()(const square_array& arr)
+{
+	kernels().bounds(arr.pos_x.data(), arr.pos_y.data(), arr.side.data(), 0.5f, arr.size(), box);
+}
+
+void contains_point_operation::operator()(const circle_array& arr)
+{
+	kernels().circles_containing(arr.pos_x.data(), arr.pos_y.data(), arr.radius.data(),
+		arr.size(), point[0], point[1], circles);
+}
+
+void contains_point_operation::operator()(const square_array& arr)
+{
+	kernels().squares_containing(arr.pos_x.data(), arr.pos_y.data(), arr.side.data(),
+		arr.size(), point[0], point[1], squares);
+}
+
+void find_overlapping(const circle& c, const square_array& arr, std::vector<uint32_t>& result)
+{
+	kernels().squares_overlapping_circle(arr.pos_x.data(), arr.pos_y.data(), arr.side.data(),
+		arr.size(), c.pos[0], c.pos[1], c.radius, result);
+}
+
+void find_overlapping(const square& s, const circle_array& arr, std::vector<uint32_t>& result)
+{
+	kernels().circles_overlapping_square(arr.pos_x.data(), arr.pos_y.data(), arr.radius.data(),
+		arr.size(), s.pos[0], s.pos[1], s.side * 0.5f, result);
+}
+
+const char* geometry_kernels_isa()
+{
+	return kernels().isa;
+}
+
+bool select_geometry_kernels(std::string_view isa)
+{
+	const geometry_kernel_table* table = nullptr;
+	if (isa == scalar_kernels.isa)
+		table = &scalar_kernels;
+#if _GEOMETRY_X86
+	else if (isa == avx2_kernels.isa && cpu_has_avx2())
+		table = &avx2_kernels;
+#endif
+	if (!table)
+		return false;
+	active_kernels() = table;
+	return true;
+}
@@ -0,0 +1,70 @@
+
+#ifndef _GEOMETRY_HPP_
+#define _GEOMETRY_HPP_
+
+#include "shape.hpp"
+
+#include <vector>
+#include <limits>
+#include <string_view>
+
+#include <stdint.h>
+
+
+//Compute visitors over shape_store arrays (shape_store::visit).
+//Both circle and square are centered at pos, square's side is its full width.
+//The loops run on SIMD kernels picked at runtime from the CPU's instruction sets
+
+class circle_array;
+class square_array;
+
+struct aabb
+{
+	vec2f min = { std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+	vec2f max = { -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() };
+
+	bool empty() const noexcept { return min[0] > max[0]; }
+};
+
+class area_operation
+{
+public:
+	double total = 0;
+
+	void operator()(const circle_array&);
+	void operator()(const square_array&);
+};
+
+class bounds_operation
+{
+public:
+	aabb box;
+
+	void operator()(const circle_array&);
+	void operator()(const square_array&);
+};
+
+//Collects indices of shapes containing the point (boundary included)
+class contains_point_operation
+{
+public:
+	vec2f point = {};
+	std::vector<uint32_t> circles;
+	std::vector<uint32_t> squares;
+
+	void operator()(const circle_array&);
+	void operator()(const square_array&);
+};
+
+//Indices of shapes in the array overlapping the given shape (touching counts)
+void find_overlapping(const circle&, const square_array&, std::vector<uint32_t>& result);
+void find_overlapping(const square&, const circle_array&, std::vector<uint32_t>& result);
+
+//Name of the instruction set the kernels were dispatched to
+const char* geometry_kernels_isa();
+
+//Switches the kernels to an instruction set by name ("scalar", "avx2"), returns false if this CPU lacks it.
+//Not thread safe, meant for tests and benchmarks comparing the kernels
+bool select_geometry_kernels(std::string_view isa);
+
+#endif //!_GEOMETRY_HPP_
@@ -0,0 +1,123 @@
+
+#include "geometry.hpp"
+#include "shape_store.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include <functional>
+
+
+//Results of every kernel for one input, to compare between instruction sets
+struct kernel_results
+{
+	double circle_area = 0, square_area = 0;
+	aabb circle_bounds, square_bounds;
+	std::vector<uint32_t> circles_containing, squares_containing;
+	std::vector<uint32_t> squares_overlapping, circles_overlapping;
+};
+
+kernel_results run_kernels(const circle_array& circles, const square_array& squares, const circle& c, const square& s)
+{
+	kernel_results r;
+
+	area_operation area;
+	area(circles);
+	r.circle_area = area.total;
+	area.total = 0;
+	area(squares);
+	r.square_area = area.total;
+
+	bounds_operation bounds;
+	bounds(circles);
+	r.circle_bounds = bounds.box;
+	bounds.box = {};
+	bounds(squares);
+	r.square_bounds = bounds.box;
+
+	contains_point_operation contains;
+	contains.point[0] = c.pos[0];
+	contains.point[1] = c.pos[1];
+	contains(circles);
+	contains(squares);
+	r.circles_containing = std::move(contains.circles);
+	r.squares_containing = std::move(contains.squares);
+
+	find_overlapping(c, squares, r.squares_overlapping);
+	find_overlapping(s, circles, r.circles_overlapping);
+	return r;
+}
+
+bool same_box(const aabb& a, const aabb& b)
+{
+	return a.min[0] == b.min[0] && a.min[1] == b.min[1] && a.max[0] == b.max[0] && a.max[1] == b.max[1];
+}
+
+//Sums are accumulated in a different order
+bool close(double a, double b)
+{
+	return std::abs(a - b) <= 1e-12 * std::max(std::abs(a), std::abs(b));
+}
+
+//Compares the vector kernels with the scalar ones on sizes around multiples of 8, so that every tail length is covered.
+//Coordinates on a 1/8 grid make exact ties (touching shapes, points on edges) common
+bool compare(const char* isa, std::mt19937& rng, bool grid)
+{
+	std::uniform_real_distribution<float> coord(-8, 8), extent(0, 4);
+	auto random = [&](std::uniform_real_distribution<float>& d)
+	{
+		const float x = d(rng);
+		return grid ? std::round(x * 8) / 8 : x;
+	};
+
+	bool ok = true;
+	for (size_t n : { 0, 1, 7, 8, 9, 15, 16, 17, 31, 33, 64, 100, 1000, 1003 })
+	{
+		for (int round = 0; round < 20; ++round)
+		{
+			circle_array circles;
+			square_array squares;
+			for (size_t i = 0; i < n; ++i)
+			{
+				circles.push_back(circle{ .pos = { random(coord), random(coord) }, .radius = random(extent) });
+				squares.push_back(square{ .pos = { random(coord), random(coord) }, .side = random(extent) });
+			}
+			const circle c{ .pos = { random(coord), random(coord) }, .radius = random(extent) };
+			const square s{ .pos = { random(coord), random(coord) }, .side = random(extent) };
+
+			select_geometry_kernels("scalar");
+			const kernel_results expected = run_kernels(circles, squares, c, s);
+			select_geometry_kernels(isa);
+			const kernel_results actual = run_kernels(circles, squares, c, s);
+
+			auto check = [&](bool equal, const char* what)
+			{
+				if (!equal && ok)
+					std::cout << "Error: " << isa << " " << what << " differs from scalar for " << n << " shapes" << (grid ? " on a grid" : "") << "\n";
+				ok = ok && equal;
+			};
+			check(close(expected.circle_area, actual.circle_area) && close(expected.square_area, actual.square_area), "area");
+			check(same_box(expected.circle_bounds, actual.circle_bounds) && same_box(expected.square_bounds, actual.square_bounds), "bounds");
+			check(expected.circles_containing == actual.circles_containing && expected.squares_containing == actual.squares_containing, "contains_point");
+			check(expected.squares_overlapping == actual.squares_overlapping && expected.circles_overlapping == actual.circles_overlapping, "find_overlapping");
+		}
+	}
+	return ok;
+}
+
+int main()
+{
+	std::mt19937 rng(1);
+	for (const char* isa : { "avx2" })
+	{
+		if (!select_geometry_kernels(isa))
+		{
+			std::cout << isa << " kernels not supported by this CPU, skipped\n";
+			continue;
+		}
+		const bool ok = compare(isa, rng, false) && compare(isa, rng, true);
+		std::cout << isa << " kernels " << (ok ? "match" : "don't match") << " the scalar ones\n";
+	}
+	return 0;
+}
@@ -1,7 +1,13 @@
 
 #include "shape.hpp"
+#include "shape_store.hpp"
+#include "geometry.hpp"
+#include "spatial_grid.hpp"
+#include "shape_arena.hpp"
 
 #include <vector>
+#include <iostream>
+#include <algorithm>
 
 int main()
 {
@@ -12,4 +18,68 @@ int main()
 	draw_operation dr{};
 	for (auto& shape : shapes)
 		std::visit(dr, shape);
+
+	visit_all(shapes, dr);
+
+	shape_store store;
+	for (auto& shape : shapes)
+		store.push_back(shape);
+	store.visit(dr);
+
+	area_operation area;
+	bounds_operation bounds;
+	contains_point_operation contains;
+	contains.point[0] = 1;
+	contains.point[1] = 0;
+	store.visit(area);
+	store.visit(bounds);
+	store.visit(contains);
+
+	std::cout << "Kernels: " << geometry_kernels_isa() << "\n";
+	std::cout << "Total area " << area.total << "\n";
+	std::cout << "Bounds (" << bounds.box.min[0] << "; " << bounds.box.min[1] << ") - (" <<
+		bounds.box.max[0] << "; " << bounds.box.max[1] << ")\n";
+	std::cout << contains.circles.size() << " circles and " << contains.squares.size() << " squares contain (1; 0)\n";
+
+	spatial_grid grid(4.f);
+	grid.build(store);
+
+	std::vector<std::pair<shape_handle, shape_handle>> pairs;
+	grid.overlapping_pairs(store, pairs);
+	std::cout << pairs.size() << " overlapping pairs\n";
+
+	store.circles.pos_x[0] += 10;
+	grid.update(store, { 0, 0 });
+	if (auto p = grid.nearest(store, 10, 0))
+		std::cout << "Nearest to (10; 0): type " << p->type << ", index " << p->index << "\n";
+
+	shape_arena arena;
+	std::vector<shape_arena::handle> handles;
+	for (auto& shape : shapes)
+		handles.push_back(arena.push_back(shape));
+	arena.erase(handles[0]);
+	arena.compact();
+	arena.for_each(dr);
+	if (const square* s = arena.get_if<square>(handles[1]))
+		std::cout << "Handle survived compaction: square with side " << s->side << "\n";
+
+	//Long-lived arenas drop the compaction history by renumbering the shapes
+	arena.rebase([&](shape_arena::handle from, shape_arena::handle to) { std::ranges::replace(handles, from, to); });
+	if (const square* s = arena.get_if<square>(handles[1]))
+		std::cout << "Handle remapped by rebase: square with side " << s->side << "\n";
+
+	//Footprint of a large scene
+	constexpr size_t scene = 1'000'000;
+	std::vector<shape> variants;
+	shape_arena scene_arena;
+	variants.reserve(scene);
+	scene_arena.reserve(scene);
+	for (size_t i = 0; i < scene; ++i)
+	{
+		const shape s = i % 3 ? shape(circle{ .pos = { float(i), 0 }, .radius = 1 }) : shape(square{ .pos = { 0, float(i) }, .side = 2 });
+		variants.push_back(s);
+		scene_arena.push_back(s);
+	}
+	std::cout << "Bytes per shape: std::vector<std::variant> " << double(variants.capacity() * sizeof(shape)) / scene <<
+		", shape_arena " << double(scene_arena.memory_usage()) / scene << "\n";
 }
@@ -1,5 +1,6 @@
 
 #include "shape.hpp"
+#include "shape_store.hpp"
 #include <iostream>
 
 void draw_operation::operator()(const circle& c) const
@@ -11,3 +12,15 @@ void draw_operation::operator()(const square& s) const
 {
 	std::cout << "Square at (" << s.pos[0] << "; " << s.pos[1] << ") with side " << s.side << "\n";
 }
+
+void draw_operation::operator()(const circle_array& arr) const
+{
+	for (size_t i = 0; i < arr.size(); ++i)
+		(*this)(arr[i]);
+}
+
+void draw_operation::operator()(const square_array& arr) const
+{
+	for (size_t i = 0; i < arr.size(); ++i)
+		(*this)(arr[i]);
+}
@@ -3,6 +3,13 @@
 #define _SHAPE_HPP_
 
 #include <variant>
+#include <span>
+#include <array>
+#include <vector>
+#include <numeric>
+#include <utility>
+
+#include <stdint.h>
 
 using vec2f = float[2];
 
@@ -27,6 +34,9 @@ public:
 
 using shape = std::variant<circle, square>;
 
+class circle_array;
+class square_array;
+
 
 
 class draw_operation
@@ -34,6 +44,39 @@ class draw_operation
 public:
 	void operator()(const circle&) const;
 	void operator()(const square&) const;
+
+	void operator()(const circle_array&) const;
+	void operator()(const square_array&) const;
 };
 
+
+
+//Batched dispatch: elements are grouped by alternative first, then the visitor
+//runs one tight loop per type instead of branching on every element
+template<class Visitor>
+void visit_all(std::span<shape> shapes, Visitor&& visitor)
+{
+	static constexpr size_t types = std::variant_size_v<shape>;
+
+	//Counting sort of element indices by variant index
+	std::array<size_t, types + 1> offsets{};
+	for (auto& s : shapes)
+		++offsets[s.index() + 1];
+	std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+	std::vector<uint32_t> order(shapes.size());
+	auto positions = offsets;
+	for (size_t i = 0; i < shapes.size(); ++i)
+		order[positions[shapes[i].index()]++] = (uint32_t)i;
+
+	[&]<size_t... I>(std::index_sequence<I...>)
+	{
+		([&]
+		{
+			for (size_t j = offsets[I]; j < offsets[I + 1]; ++j)
+				visitor(*std::get_if<I>(&shapes[order[j]]));
+		}(), ...);
+	}(std::make_index_sequence<types>{});
+}
+
 #endif //!_SHAPE_HPP_
@@ -0,0 +1,305 @@
+
+#ifndef _SHAPE_ARENA_HPP_
+#define _SHAPE_ARENA_HPP_
+
+#include "shape.hpp"
+
+#include <vector>
+#include <variant>
+#include <tuple>
+#include <memory_resource>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include <bit>
+
+#include <stdint.h>
+#include <string.h>
+
+
+//Order-preserving polymorphic container with compact storage.
+//Shapes are packed at a fixed stride (the largest alternative) in chunks taken from a memory_resource,
+//so appending never allocates per shape and never moves existing ones, and the type tag of every position
+//lives in a separate byte array instead of padding each element: 13 bytes per circle or square.
+//
+//A handle is the shape's insertion ordinal. erase() only retags the shape, compact() slides the live shapes
+//over the erased ones and records the erased ordinals in a sorted list, so a handle resolves to ordinal minus
+//the number of compacted ordinals below it: handles stay valid across compaction and are never reused,
+//at 8 bytes per compacted shape and a binary search per lookup once anything was compacted.
+//That history only grows, so long-lived arenas with churn call rebase() instead of compact() once in a while:
+//it renumbers the live shapes, reports every new handle and drops the history
+template<class... Shapes>
+class basic_shape_arena
+{
+	static_assert(sizeof...(Shapes) < 255, "basic_shape_arena: tag 255 marks erased shapes");
+	static_assert((std::is_trivially_copyable_v<Shapes> && ...), "basic_shape_arena: shapes are moved with memcpy");
+
+	template<size_t I>
+	using alternative = std::tuple_element_t<I, std::tuple<Shapes...>>;
+
+	template<class S>
+	static constexpr uint8_t tag_of = []
+	{
+		uint8_t result = 0;
+		const bool found = ((std::is_same_v<S, Shapes> ? true : (++result, false)) || ...);
+		return found ? result : uint8_t(-1);
+	}();
+
+	static constexpr size_t align = std::max({ alignof(Shapes)... });
+	static constexpr size_t stride = (std::max({ sizeof(Shapes)... }) + align - 1) / align * align;
+	static constexpr uint8_t erased = 0xFF;
+	static constexpr size_t npos = size_t(-1);
+
+	std::pmr::memory_resource* m_resource;
+	size_t m_chunk_log2;
+	std::pmr::vector<std::byte*> m_chunks;
+	std::pmr::vector<uint8_t> m_tags; //Per position
+	std::pmr::vector<uint64_t> m_compacted; //Sorted ordinals of the shapes compact() removed, relative to m_base
+	uint64_t m_base = 0; //Ordinals below it were cleared
+	size_t m_size = 0;
+
+	std::byte* storage(size_t position) const noexcept
+	{
+		return m_chunks[position >> m_chunk_log2] + (position & ((size_t(1) << m_chunk_log2) - 1)) * stride;
+	}
+
+	//Calls visitor(S&) with the shape at position, const S& for a const arena
+	template<class Self, class Visitor>
+	static void dispatch(Self& self, size_t position, Visitor& visitor)
+	{
+		[&]<size_t... I>(std::index_sequence<I...>)
+		{
+			((self.m_tags[position] == I ? (void)visitor(*std::launder(reinterpret_cast<
+				std::conditional_t<std::is_const_v<Self>, const alternative<I>, alternative<I>>*>(self.storage(position)))) : (void)0), ...);
+		}(std::make_index_sequence<sizeof...(Shapes)>{});
+	}
+
+	void release_chunks(size_t positions)
+	{
+		const size_t chunk_bytes = stride << m_chunk_log2;
+		const size_t needed = (positions + (size_t(1) << m_chunk_log2) - 1) >> m_chunk_log2;
+		for (size_t i = needed; i < m_chunks.size(); ++i)
+			m_resource->deallocate(m_chunks[i], chunk_bytes, align);
+		m_chunks.resize(std::min(needed, m_chunks.size()));
+	}
+
+public:
+	struct handle
+	{
+		uint64_t ordinal;
+
+		bool operator==(const handle&) const = default;
+	};
+
+	//chunk_shapes is rounded up to a power of two
+	explicit basic_shape_arena(std::pmr::memory_resource* resource = std::pmr::get_default_resource(), size_t chunk_shapes = 1 << 14)
+		: m_resource(resource), m_chunk_log2(std::bit_width(std::bit_ceil(std::max<size_t>(chunk_shapes, 1))) - 1),
+		m_chunks(resource), m_tags(resource), m_compacted(resource)
+	{
+	}
+
+	//The source is left empty, its handles resolve in the new arena
+	basic_shape_arena(basic_shape_arena&& other) noexcept
+		: m_resource(other.m_resource), m_chunk_log2(other.m_chunk_log2), m_chunks(std::move(other.m_chunks)),
+		m_tags(std::move(other.m_tags)), m_compacted(std::move(other.m_compacted)), m_base(other.m_base), m_size(other.m_size)
+	{
+		other.m_chunks.clear();
+		other.m_tags.clear();
+		other.m_compacted.clear();
+		other.m_base += m_tags.size() + m_compacted.size();
+		other.m_size = 0;
+	}
+
+	basic_shape_arena(const basic_shape_arena&) = delete;
+	basic_shape_arena& operator=(const basic_shape_arena&) = delete;
+
+	~basic_shape_arena()
+	{
+		release_chunks(0);
+	}
+
+	//Live shapes
+	size_t size() const noexcept
+	{
+		return m_size;
+	}
+	bool empty() const noexcept
+	{
+		return m_size == 0;
+	}
+	//Positions in use, including erased shapes not compacted away yet
+	size_t positions() const noexcept
+	{
+		return m_tags.size();
+	}
+
+	void reserve(size_t shapes)
+	{
+		m_tags.reserve(shapes);
+		while (m_chunks.size() << m_chunk_log2 < shapes)
+			m_chunks.push_back(static_cast<std::byte*>(m_resource->allocate(stride << m_chunk_log2, align)));
+	}
+
+	template<class S>
+		requires (tag_of<S> != uint8_t(-1))
+	handle push_back(const S& x)
+	{
+		const size_t position = m_tags.size();
+		if (position == m_chunks.size() << m_chunk_log2)
+			m_chunks.push_back(static_cast<std::byte*>(m_resource->allocate(stride << m_chunk_log2, align)));
+		::new (storage(position)) S(x);
+		m_tags.push_back(tag_of<S>);
+		++m_size;
+		return { m_base + position + m_compacted.size() };
+	}
+
+	handle push_back(const std::variant<Shapes...>& x)
+	{
+		return std::visit([this](const auto& s) { return push_back(s); }, x);
+	}
+
+	//Current position of the shape, npos for erased shapes
+	size_t position(handle h) const noexcept
+	{
+		if (h.ordinal < m_base)
+			return npos;
+		const uint64_t ordinal = h.ordinal - m_base;
+		const auto it = std::lower_bound(m_compacted.begin(), m_compacted.end(), ordinal);
+		if (it != m_compacted.end() && *it == ordinal)
+			return npos;
+		const size_t result = size_t(ordinal - (it - m_compacted.begin()));
+		return result < m_tags.size() && m_tags[result] != erased ? result : npos;
+	}
+
+	bool contains(handle h) const noexcept
+	{
+		return position(h) != npos;
+	}
+
+	//Leaves a hole until the next compact()
+	bool erase(handle h) noexcept
+	{
+		const size_t p = position(h);
+		if (p == npos)
+			return false;
+		m_tags[p] = erased;
+		--m_size;
+		return true;
+	}
+
+	template<class S>
+		requires (tag_of<S> != uint8_t(-1))
+	S* get_if(handle h) noexcept
+	{
+		const size_t p = position(h);
+		if (p == npos || m_tags[p] != tag_of<S>)
+			return nullptr;
+		return std::launder(reinterpret_cast<S*>(storage(p)));
+	}
+	template<class S>
+		requires (tag_of<S> != uint8_t(-1))
+	const S* get_if(handle h) const noexcept
+	{
+		return const_cast<basic_shape_arena*>(this)->get_if<S>(h);
+	}
+
+	//Calls visitor(S&) on the shape of a valid handle
+	template<class Visitor>
+	void visit(handle h, Visitor&& visitor)
+	{
+		dispatch(*this, position(h), visitor);
+	}
+	template<class Visitor>
+	void visit(handle h, Visitor&& visitor) const
+	{
+		dispatch(*this, position(h), visitor);
+	}
+
+	//Calls visitor(S&) on every live shape in insertion order
+	template<class Visitor>
+	void for_each(Visitor&& visitor)
+	{
+		for (size_t i = 0; i < m_tags.size(); ++i)
+			if (m_tags[i] != erased)
+				dispatch(*this, i, visitor);
+	}
+	template<class Visitor>
+	void for_each(Visitor&& visitor) const
+	{
+		for (size_t i = 0; i < m_tags.size(); ++i)
+			if (m_tags[i] != erased)
+				dispatch(*this, i, visitor);
+	}
+
+	//Moves the live shapes over the erased ones keeping their order, then frees the chunks no longer needed
+	void compact()
+	{
+		const size_t previously_compacted = m_compacted.size();
+		size_t dst = 0, skipped = 0;
+		for (size_t src = 0; src < m_tags.size(); ++src)
+		{
+			if (m_tags[src] != erased)
+			{
+				if (src != dst)
+				{
+					memcpy(storage(dst), storage(src), stride);
+					m_tags[dst] = m_tags[src];
+				}
+				++dst;
+				continue;
+			}
+
+			//Ordinal of position src: src plus the earlier compacted ordinals below it
+			while (skipped < previously_compacted && m_compacted[skipped] <= src + skipped)
+				++skipped;
+			m_compacted.push_back(src + skipped);
+		}
+
+		std::inplace_merge(m_compacted.begin(), m_compacted.begin() + previously_compacted, m_compacted.end());
+		m_tags.resize(dst);
+		release_chunks(dst);
+	}
+
+	//compact(), then numbers the live shapes from scratch and forgets the compacted ordinals.
+	//Every handle changes: remap(old handle, new handle) is called for each live shape in order,
+	//old handles no longer resolve afterwards
+	template<class Remap>
+	void rebase(Remap&& remap)
+	{
+		compact();
+
+		const uint64_t new_base = m_base + m_tags.size() + m_compacted.size();
+		size_t skipped = 0;
+		for (size_t p = 0; p < m_tags.size(); ++p)
+		{
+			while (skipped < m_compacted.size() && m_compacted[skipped] <= p + skipped)
+				++skipped;
+			remap(handle{ m_base + p + skipped }, handle{ new_base + p });
+		}
+
+		m_base = new_base;
+		m_compacted.clear();
+		m_compacted.shrink_to_fit();
+	}
+
+	//Erases every shape and invalidates every handle, keeping the chunks for reuse
+	void clear() noexcept
+	{
+		m_base += m_tags.size() + m_compacted.size();
+		m_tags.clear();
+		m_compacted.clear();
+		m_size = 0;
+	}
+
+	//Bytes held for shapes, tags and compacted ordinals
+	size_t memory_usage() const noexcept
+	{
+		return (m_chunks.size() * stride << m_chunk_log2) + m_chunks.capacity() * sizeof(std::byte*) +
+			m_tags.capacity() + m_compacted.capacity() * sizeof(uint64_t);
+	}
+};
+
+using shape_arena = basic_shape_arena<circle, square>;
+
+#endif //!_SHAPE_ARENA_HPP_
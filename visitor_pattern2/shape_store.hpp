@@ -0,0 +1,132 @@
+
+#ifndef _SHAPE_STORE_HPP_
+#define _SHAPE_STORE_HPP_
+
+#include "shape.hpp"
+
+#include <vector>
+#include <variant>
+
+#include <cstddef>
+
+
+//Structure-of-arrays storage for a single shape type.
+//Every field lives in its own contiguous array, so batch operations
+//over one type are plain loops over floats
+
+class circle_array
+{
+public:
+	std::vector<float> pos_x;
+	std::vector<float> pos_y;
+	std::vector<float> radius;
+
+	size_t size() const noexcept { return radius.size(); }
+	bool empty() const noexcept { return radius.empty(); }
+
+	void push_back(const circle& c)
+	{
+		pos_x.push_back(c.pos[0]);
+		pos_y.push_back(c.pos[1]);
+		radius.push_back(c.radius);
+	}
+
+	circle operator[](size_t i) const
+	{
+		return circle{ .pos = { pos_x[i], pos_y[i] }, .radius = radius[i] };
+	}
+
+	void reserve(size_t n)
+	{
+		pos_x.reserve(n);
+		pos_y.reserve(n);
+		radius.reserve(n);
+	}
+
+	void clear() noexcept
+	{
+		pos_x.clear();
+		pos_y.clear();
+		radius.clear();
+	}
+};
+
+class square_array
+{
+public:
+	std::vector<float> pos_x;
+	std::vector<float> pos_y;
+	std::vector<float> side;
+
+	size_t size() const noexcept { return side.size(); }
+	bool empty() const noexcept { return side.empty(); }
+
+	void push_back(const square& s)
+	{
+		pos_x.push_back(s.pos[0]);
+		pos_y.push_back(s.pos[1]);
+		side.push_back(s.side);
+	}
+
+	square operator[](size_t i) const
+	{
+		return square{ .pos = { pos_x[i], pos_y[i] }, .side = side[i] };
+	}
+
+	void reserve(size_t n)
+	{
+		pos_x.reserve(n);
+		pos_y.reserve(n);
+		side.reserve(n);
+	}
+
+	void clear() noexcept
+	{
+		pos_x.clear();
+		pos_y.clear();
+		side.clear();
+	}
+};
+
+
+
+//Shape container partitioned by type. Order between shapes of different types is not kept.
+//Visitors are invoked once per type with the whole array instead of once per shape
+class shape_store
+{
+public:
+	circle_array circles;
+	square_array squares;
+
+	void push_back(const circle& c) { circles.push_back(c); }
+	void push_back(const square& s) { squares.push_back(s); }
+	void push_back(const shape& s)
+	{
+		std::visit([this](const auto& x) { push_back(x); }, s);
+	}
+
+	size_t size() const noexcept { return circles.size() + squares.size(); }
+	bool empty() const noexcept { return circles.empty() && squares.empty(); }
+
+	void clear() noexcept
+	{
+		circles.clear();
+		squares.clear();
+	}
+
+	//Calls visitor(circle_array&) and visitor(square_array&)
+	template<class Visitor>
+	void visit(Visitor&& visitor)
+	{
+		visitor(circles);
+		visitor(squares);
+	}
+	template<class Visitor>
+	void visit(Visitor&& visitor) const
+	{
+		visitor(circles);
+		visitor(squares);
+	}
+};
+
+#endif //!_SHAPE_STORE_HPP_
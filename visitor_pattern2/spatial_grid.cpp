@@ -0,0 +1,325 @@
+
+#include "spatial_grid.hpp"
+#include "shape_store.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+
+namespace
+{
+	template<class T, size_t I = 0>
+	constexpr uint32_t shape_type_of()
+	{
+		if constexpr (std::is_same_v<std::variant_alternative_t<I, shape>, T>)
+			return I;
+		else
+			return shape_type_of<T, I + 1>();
+	}
+
+	constexpr uint32_t circle_type = shape_type_of<circle>();
+	constexpr uint32_t square_type = shape_type_of<square>();
+
+	//Cell coordinates are clamped to [-2^29; 2^29], so differences of two of them and cx + r in nearest() fit in int32_t
+	constexpr float max_cell_coord = float(1 << 29);
+
+	aabb bounds_of(const shape_store& store, shape_handle h)
+	{
+		float x, y, e;
+		if (h.type == circle_type)
+		{
+			x = store.circles.pos_x[h.index];
+			y = store.circles.pos_y[h.index];
+			e = store.circles.radius[h.index];
+		}
+		else
+		{
+			x = store.squares.pos_x[h.index];
+			y = store.squares.pos_y[h.index];
+			e = store.squares.side[h.index] * 0.5f;
+		}
+		return aabb{ .min = { x - e, y - e }, .max = { x + e, y + e } };
+	}
+
+	bool boxes_intersect(const aabb& a, const aabb& b)
+	{
+		return a.min[0] <= b.max[0] && b.min[0] <= a.max[0] &&
+			a.min[1] <= b.max[1] && b.min[1] <= a.max[1];
+	}
+
+	//Squared distance from the point to the box, 0 if inside
+	float box_distance2(const aabb& box, float x, float y)
+	{
+		const float dx = std::max({ box.min[0] - x, 0.f, x - box.max[0] });
+		const float dy = std::max({ box.min[1] - y, 0.f, y - box.max[1] });
+		return dx * dx + dy * dy;
+	}
+
+	float distance_to(const shape_store& store, shape_handle h, const aabb& box, float x, float y)
+	{
+		if (h.type == circle_type)
+		{
+			const float dx = store.circles.pos_x[h.index] - x;
+			const float dy = store.circles.pos_y[h.index] - y;
+			return std::max(std::sqrt(dx * dx + dy * dy) - store.circles.radius[h.index], 0.f);
+		}
+		return std::sqrt(box_distance2(box, x, y));
+	}
+
+	bool intersects_box(const shape_store& store, shape_handle h, const aabb& own_box, const aabb& box)
+	{
+		if (!boxes_intersect(own_box, box))
+			return false;
+		if (h.type == circle_type)
+		{
+			const float r = store.circles.radius[h.index];
+			return box_distance2(box, store.circles.pos_x[h.index], store.circles.pos_y[h.index]) <= r * r;
+		}
+		return true;
+	}
+
+	bool shapes_overlap(const shape_store& store, shape_handle a, aabb box_a, shape_handle b, aabb box_b)
+	{
+		if (!boxes_intersect(box_a, box_b))
+			return false;
+
+		if (a.type == square_type && b.type == square_type)
+			return true;
+		if (a.type == circle_type && b.type == circle_type)
+		{
+			const float dx = store.circles.pos_x[a.index] - store.circles.pos_x[b.index];
+			const float dy = store.circles.pos_y[a.index] - store.circles.pos_y[b.index];
+			const float r = store.circles.radius[a.index] + store.circles.radius[b.index];
+			return dx * dx + dy * dy <= r * r;
+		}
+
+		if (a.type != circle_type)
+			std::swap(a, b), std::swap(box_a, box_b);
+		return intersects_box(store, a, box_a, box_b);
+	}
+}
+
+
+
+spatial_grid::spatial_grid(float cell_size)
+	: cell_size(cell_size), inv_cell_size(1 / cell_size)
+{
+}
+
+uint64_t spatial_grid::cell_key(int32_t x, int32_t y)
+{
+	return (uint64_t(uint32_t(x)) << 32) | uint32_t(y);
+}
+
+int32_t spatial_grid::cell_coord(float x) const
+{
+	const float c = std::floor(x * inv_cell_size);
+	//Also maps infinities and NaN to a valid coordinate
+	return (int32_t)(!(c >= -max_cell_coord) ? -max_cell_coord : c > max_cell_coord ? max_cell_coord : c);
+}
+
+spatial_grid::cell_range spatial_grid::cells_of(const aabb& box) const
+{
+	return { cell_coord(box.min[0]), cell_coord(box.min[1]), cell_coord(box.max[0]), cell_coord(box.max[1]) };
+}
+
+spatial_grid::item& spatial_grid::item_of(shape_handle h)
+{
+	auto& arr = items[h.type];
+	if (arr.size() <= h.index)
+		arr.resize(h.index + 1);
+	return arr[h.index];
+}
+
+const spatial_grid::item& spatial_grid::item_of(shape_handle h) const
+{
+	return items[h.type][h.index];
+}
+
+void spatial_grid::register_item(shape_handle h, item& it)
+{
+	for (int32_t x = it.cells.x0; x <= it.cells.x1; ++x)
+		for (int32_t y = it.cells.y0; y <= it.cells.y1; ++y)
+			cells[cell_key(x, y)].push_back(h);
+
+	occupied.x0 = std::min(occupied.x0, it.cells.x0);
+	occupied.y0 = std::min(occupied.y0, it.cells.y0);
+	occupied.x1 = std::max(occupied.x1, it.cells.x1);
+	occupied.y1 = std::max(occupied.y1, it.cells.y1);
+	it.registered = true;
+}
+
+void spatial_grid::unregister_item(shape_handle h, item& it)
+{
+	for (int32_t x = it.cells.x0; x <= it.cells.x1; ++x)
+	{
+		for (int32_t y = it.cells.y0; y <= it.cells.y1; ++y)
+		{
+			auto p = cells.find(cell_key(x, y));
+			auto& cell = p->second;
+			auto q = std::find(cell.begin(), cell.end(), h);
+			*q = cell.back();
+			cell.pop_back();
+			if (cell.empty())
+				cells.erase(p);
+		}
+	}
+	it.registered = false;
+}
+
+void spatial_grid::clear()
+{
+	cells.clear();
+	items[0].clear();
+	items[1].clear();
+	occupied = { INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN };
+}
+
+void spatial_grid::build(const shape_store& store)
+{
+	clear();
+	items[circle_type].reserve(store.circles.size());
+	items[square_type].reserve(store.squares.size());
+
+	for (uint32_t i = 0; i < store.circles.size(); ++i)
+		insert(store, { circle_type, i });
+	for (uint32_t i = 0; i < store.squares.size(); ++i)
+		insert(store, { square_type, i });
+}
+
+void spatial_grid::insert(const shape_store& store, shape_handle h)
+{
+	item& it = item_of(h);
+	it.box = bounds_of(store, h);
+	it.cells = cells_of(it.box);
+	register_item(h, it);
+}
+
+void spatial_grid::update(const shape_store& store, shape_handle h)
+{
+	item& it = item_of(h);
+	if (!it.registered)
+		return insert(store, h);
+
+	it.box = bounds_of(store, h);
+	const cell_range new_cells = cells_of(it.box);
+	if (new_cells == it.cells)
+		return;
+
+	unregister_item(h, it);
+	it.cells = new_cells;
+	register_item(h, it);
+}
+
+void spatial_grid::query_range(const shape_store& store, const aabb& box, std::vector<shape_handle>& result) const
+{
+	if (box.empty())
+		return;
+
+	const cell_range q = cells_of(box);
+	const int32_t x0 = std::max(q.x0, occupied.x0), x1 = std::min(q.x1, occupied.x1);
+	const int32_t y0 = std::max(q.y0, occupied.y0), y1 = std::min(q.y1, occupied.y1);
+
+	for (int32_t x = x0; x <= x1; ++x)
+	{
+		for (int32_t y = y0; y <= y1; ++y)
+		{
+			auto p = cells.find(cell_key(x, y));
+			if (p == cells.end())
+				continue;
+
+			for (shape_handle h : p->second)
+			{
+				const item& it = item_of(h);
+				//Report each shape only from the first cell shared by it and the query
+				if (x != std::max(it.cells.x0, q.x0) || y != std::max(it.cells.y0, q.y0))
+					continue;
+				if (intersects_box(store, h, it.box, box))
+					result.push_back(h);
+			}
+		}
+	}
+}
+
+std::optional<shape_handle> spatial_grid::nearest(const shape_store& store, float px, float py) const
+{
+	if (cells.empty() || std::isnan(px) || std::isnan(py))
+		return std::nullopt;
+
+	const int32_t cx = cell_coord(px);
+	const int32_t cy = cell_coord(py);
+
+	std::optional<shape_handle> best;
+	float best_distance = INFINITY;
+
+	auto visit_cell = [&]
+	(int32_t x, int32_t y)
+	{
+		if (x < occupied.x0 || x > occupied.x1 || y < occupied.y0 || y > occupied.y1)
+			return;
+		auto p = cells.find(cell_key(x, y));
+		if (p == cells.end())
+			return;
+		for (shape_handle h : p->second)
+		{
+			const float d = distance_to(store, h, item_of(h).box, px, py);
+			if (!best || d < best_distance) //Distances to far points can overflow to infinity
+			{
+				best_distance = d;
+				best = h;
+			}
+		}
+	};
+
+	//Rings of cells at growing Chebyshev distance, starting from the first one touching occupied cells
+	const int32_t first_ring = std::max({ occupied.x0 - cx, cx - occupied.x1, occupied.y0 - cy, cy - occupied.y1, 0 });
+	const int32_t last_ring = std::max({ cx - occupied.x0, occupied.x1 - cx, cy - occupied.y0, occupied.y1 - cy });
+
+	for (int32_t r = first_ring; r <= last_ring; ++r)
+	{
+		if (r == 0)
+			visit_cell(cx, cy);
+		else
+		{
+			for (int32_t x = std::max(cx - r, occupied.x0); x <= std::min(cx + r, occupied.x1); ++x)
+			{
+				visit_cell(x, cy - r);
+				visit_cell(x, cy + r);
+			}
+			for (int32_t y = std::max(cy - r + 1, occupied.y0); y <= std::min(cy + r - 1, occupied.y1); ++y)
+			{
+				visit_cell(cx - r, y);
+				visit_cell(cx + r, y);
+			}
+		}
+
+		//Shapes not seen yet lie entirely in rings > r, at least r cells away
+		if (best && best_distance <= r * cell_size)
+			break;
+	}
+	return best;
+}
+
+void spatial_grid::overlapping_pairs(const shape_store& store, std::vector<std::pair<shape_handle, shape_handle>>& result) const
+{
+	for (auto& [key, cell] : cells)
+	{
+		const int32_t x = int32_t(uint32_t(key >> 32));
+		const int32_t y = int32_t(uint32_t(key));
+
+		for (size_t i = 0; i < cell.size(); ++i)
+		{
+			const item& a = item_of(cell[i]);
+			for (size_t j = i + 1; j < cell.size(); ++j)
+			{
+				const item& b = item_of(cell[j]);
+				//Report each pair only from the first cell both shapes share
+				if (x != std::max(a.cells.x0, b.cells.x0) || y != std::max(a.cells.y0, b.cells.y0))
+					continue;
+				if (shapes_overlap(store, cell[i], a.box, cell[j], b.box))
+					result.emplace_back(cell[i], cell[j]);
+			}
+		}
+	}
+}
@@ -0,0 +1,88 @@
+
+#ifndef _SPATIAL_GRID_HPP_
+#define _SPATIAL_GRID_HPP_
+
+#include "geometry.hpp"
+
+#include <vector>
+#include <utility>
+#include <optional>
+#include <unordered_map>
+
+#include <stdint.h>
+
+
+class shape_store;
+
+//Refers to a shape in a shape_store: type is the shape variant index, index is the position in its array
+struct shape_handle
+{
+	uint32_t type;
+	uint32_t index;
+
+	bool operator==(const shape_handle&) const = default;
+};
+
+//Uniform hash grid over a shape_store. Every shape is registered in all cells its bounding box covers.
+//The grid does not own the shapes: after moving a shape in the store, call update() for it
+class spatial_grid
+{
+public:
+	spatial_grid(float cell_size);
+
+	//Drops everything and registers every shape of the store
+	void build(const shape_store&);
+
+	//Registers a shape appended to the store after build()
+	void insert(const shape_store&, shape_handle);
+
+	//Re-registers a shape whose position or size has changed in the store
+	void update(const shape_store&, shape_handle);
+
+	void clear();
+
+	//Shapes intersecting the box (boundary included)
+	void query_range(const shape_store&, const aabb&, std::vector<shape_handle>& result) const;
+
+	//Shape closest to the point, distance is 0 for shapes containing it
+	std::optional<shape_handle> nearest(const shape_store&, float x, float y) const;
+
+	//Every pair of overlapping shapes, each pair reported once
+	void overlapping_pairs(const shape_store&, std::vector<std::pair<shape_handle, shape_handle>>& result) const;
+
+private:
+	struct cell_range
+	{
+		int32_t x0, y0, x1, y1;
+
+		bool operator==(const cell_range&) const = default;
+	};
+
+	struct item
+	{
+		aabb box;
+		cell_range cells;
+		bool registered = false;
+	};
+
+	float cell_size;
+	float inv_cell_size;
+
+	std::unordered_map<uint64_t, std::vector<shape_handle>> cells;
+	std::vector<item> items[2];
+
+	//Cell bounds covering every registered shape, used to stop the nearest neighbour search
+	cell_range occupied = { INT32_MAX, INT32_MAX, INT32_MIN, INT32_MIN };
+
+	static uint64_t cell_key(int32_t x, int32_t y);
+	int32_t cell_coord(float) const;
+	cell_range cells_of(const aabb&) const;
+
+	item& item_of(shape_handle);
+	const item& item_of(shape_handle) const;
+
+	void register_item(shape_handle, item&);
+	void unregister_item(shape_handle, item&);
+};
+
+#endif //!_SPATIAL_GRID_HPP_